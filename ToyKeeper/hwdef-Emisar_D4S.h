@@ -11,4 +11,10 @@
 #define AUXLED_PIN   PB4    // pin 3
 #endif
 
+// smooth out the bottom of the ramp, between PWM steps
+// (the cfg needs PWM1_DITHER, from level_calc.py --dither N)
+// (off until it has been tested on hardware, and its current measured;
+//  the simulator doesn't run the timer 0 overflow which does the work)
+//#define USE_PWM_DITHER
+
 #endif
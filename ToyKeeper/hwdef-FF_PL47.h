@@ -23,5 +23,7 @@
 #include "hwdef-Emisar_D4S.h"
 #undef FSM_EMISAR_D4S_DRIVER
 #undef FSM_EMISAR_D4_DRIVER
+// (no PWM1_DITHER in the PL47 ramps yet)
+#undef USE_PWM_DITHER
 
 #endif
@@ -22,6 +22,13 @@
 #define PWM1_LVL OCR1B      // OCR1B is the output compare register for PB0
 #endif
 
+// Timer1 uses OCR1C as its TOP, so the 7135 can do dynamic PWM
+// (the FET is on Timer0, which can't, but it's only used at 255 anyway)
+#define USE_DYN_PWM
+#define PWM1_TOP OCR1C
+#define PWM1_CNT TCNT1
+#define PWM1_PHASE_SYNC
+
 #ifndef PWM2_PIN
 #define PWM2_PIN PB0        // pin 5, FET PWM
 #define PWM2_LVL OCR0A      // OCR0A is the output compare register for PB4
@@ -80,6 +80,9 @@
 // enable FSM features needed by strobe modes
 #include "strobe-modes-fsm.h"
 
+// allocate software timers for whichever features need them
+#include "timers-fsm.h"
+
 // figure out how many bytes of eeprom are needed,
 // based on which UI features are enabled
 // (include this one last)
@@ -88,6 +91,8 @@
 
 /********* bring in FSM / SpaghettiMonster *********/
 #define USE_IDLE_MODE  // reduce power use while awake and no tasks are pending
+#define USE_FAST_BUTTON  // register button presses without waiting for a tick
+#define USE_COROUTINES  // run blinky modes without blocking in loop()
 
 #include "spaghetti-monster.h"
 
@@ -265,6 +270,10 @@ void loop() {
     // "current_state" is volatile, so cache it to reduce code size
     StatePtr state = current_state;
 
+    // animations below are coroutines, which return to the main loop
+    // whenever they're waiting...  and say whether the MCU can doze
+    uint8_t co = CO_BUSY;
+
     #ifdef USE_AUX_RGB_LEDS_WHILE_ON
     // display battery charge on RGB button during use
     if (! setting_rgb_mode_now) rgb_led_voltage_readout(1);
@@ -285,7 +294,7 @@ void loop() {
          ||  ((state == momentary_state) && (momentary_mode == 1) && (momentary_active))
          #endif
          ) {
-        strobe_state_iter();
+        co = strobe_state_iter(&loop_co);
     }
     #endif  // #ifdef USE_STROBE_STATE
 
@@ -297,14 +306,7 @@ void loop() {
 
     #ifdef USE_BATTCHECK
     else if (state == battcheck_state) {
-        battcheck();
-        #ifdef USE_SIMPLE_UI
-        // in simple mode, turn off after one readout
-        // FIXME: can eat the next button press
-        //        (state changes in loop() act weird)
-        if (simple_ui_active) set_state_deferred(off_state, 0);
-        else nice_delay_ms(1000);
-        #endif
+        co = battcheck_iter(&loop_co);
     }
     #endif
 
@@ -318,21 +320,23 @@ void loop() {
 
     #ifdef USE_BEACON_MODE
     else if (state == beacon_state) {
-        beacon_mode_iter();
+        co = beacon_mode_iter(&loop_co);
     }
     #endif
 
     #if defined(USE_SOS_MODE) && defined(USE_SOS_MODE_IN_BLINKY_GROUP)
     else if (state == sos_state) {
-        sos_mode_iter();
+        co = sos_mode_iter(&loop_co);
     }
     #endif
 
     #ifdef USE_IDLE_MODE
     else {
         // doze until next clock tick
-        idle_mode();
+        co = CO_IDLE;
     }
+
+    if (co == CO_IDLE) idle_mode();
     #endif
 
 }
@@ -349,6 +353,10 @@ void low_voltage() {
 
     if (0) {}  // placeholder
 
+    // still in setup() (like during factory reset), so there's no UI yet
+    // (set_state() here would replace default_state, and LVP with it)
+    else if (state == default_state) {}
+
     #ifdef USE_STROBE_STATE
     // "step down" from strobe to something low
     else if (state == strobe_state) {
@@ -23,6 +23,11 @@
 #include "battcheck-mode.h"
 
 uint8_t battcheck_state(Event event, uint16_t arg) {
+    // don't let an old, interrupted readout count against this one
+    if (event == EV_enter_state) {
+        CO_RESET(&batt_co);
+    }
+
     ////////// Every action below here is blocked in the simple UI //////////
     #ifdef USE_SIMPLE_UI
     if (simple_ui_active) {
@@ -59,6 +64,28 @@ uint8_t battcheck_state(Event event, uint16_t arg) {
     return EVENT_NOT_HANDLED;
 }
 
+uint8_t battcheck_iter(Coroutine *co) {
+    // one readout per call
+    CO_BEGIN(co);
+    #ifdef USE_SIMPLE_UI
+    // input restarts loop() animations, but in simple mode it should end
+    // the readout instead  (like it did when nice_delay_ms() aborted)
+    if (simple_ui_active && batt_co.line) {
+        set_state_deferred(off_state, 0);
+        return CO_DONE;
+    }
+    #endif
+    CO_CALL(co, &batt_co, co_battcheck(&batt_co));
+    #ifdef USE_SIMPLE_UI
+    // in simple mode, turn off after one readout
+    // FIXME: can eat the next button press
+    //        (state changes in loop() act weird)
+    if (simple_ui_active) set_state_deferred(off_state, 0);
+    else CO_SLEEP_MS(co, 1000);
+    #endif
+    CO_END(co);
+}
+
 #ifdef USE_VOLTAGE_CORRECTION
 // the user can adjust the battery measurements... on a scale of 1 to 13
 // 1 = subtract 0.30V
@@ -20,7 +20,11 @@
 #ifndef BATTCHECK_MODE_H
 #define BATTCHECK_MODE_H
 
+// the readout in progress  (still running if a click interrupted it)
+Coroutine batt_co;
+
 uint8_t battcheck_state(Event event, uint16_t arg);
+uint8_t battcheck_iter(Coroutine *co);
 
 #ifdef USE_VOLTAGE_CORRECTION
 void voltage_config_save(uint8_t step, uint8_t value);
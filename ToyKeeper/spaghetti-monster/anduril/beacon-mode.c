@@ -22,14 +22,16 @@
 
 #include "beacon-mode.h"
 
-inline void beacon_mode_iter() {
-    // one iteration of main loop()
-    if (! button_last_state) {
-        set_level(memorized_level);
-        nice_delay_ms(100);
-        set_level(0);
-        nice_delay_ms(((beacon_seconds) * 1000) - 100);
-    }
+uint8_t beacon_mode_iter(Coroutine *co) {
+    // one blink per call
+    CO_BEGIN(co);
+    // button held?  doze until it's released
+    if (button_last_state) return CO_IDLE;
+    set_level(memorized_level);
+    CO_DELAY_MS(co, 100);
+    set_level(0);
+    CO_SLEEP_MS(co, ((beacon_seconds) * 1000) - 100);
+    CO_END(co);
 }
 
 uint8_t beacon_state(Event event, uint16_t arg) {
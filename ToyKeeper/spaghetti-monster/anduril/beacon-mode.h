@@ -25,7 +25,7 @@ uint8_t beacon_seconds = 2;
 
 // beacon mode
 uint8_t beacon_state(Event event, uint16_t arg);
-inline void beacon_mode_iter();
+uint8_t beacon_mode_iter(Coroutine *co);
 
 
 #endif
@@ -1,57 +1,90 @@
 #!/bin/sh
 
-# Usage: build-all.sh [pattern]
+# Usage: build-all.sh [-j jobs] [pattern]
 # If pattern given, only build targets which match.
-
-if [ ! -z "$1" ]; then
-  SEARCH="$1"
-fi
+# Each target builds in build/NAME/, several at once (one per CPU by
+# default), and only gets rebuilt when its source or flags have changed.
+# The results go into build/summary.txt, one line per target:
+#   NAME STATUS FLASH_BYTES RAM_BYTES
+# ... where STATUS is "built", "unchanged", or "failed".
 
 UI=anduril
 
-date '+#define VERSION_NUMBER "%Y%m%d"' > version.h
-
-PASS=0
-FAIL=0
-PASSED=''
-FAILED=''
-
-for TARGET in cfg-*.h ; do
-
-  # maybe limit builds to a specific pattern
-  if [ ! -z "$SEARCH" ]; then
-    echo "$TARGET" | grep -i "$SEARCH" > /dev/null
-    if [ 0 != $? ]; then continue ; fi
-  fi
+# build one target  (build-all.sh runs itself this way, in parallel)
+if [ "--one" = "$1" ]; then
+  TARGET="$2"
 
   # friendly name for this build
   NAME=$(echo "$TARGET" | perl -ne '/cfg-(.*).h/ && print "$1\n";')
-  echo "===== $NAME ====="
+  DIR="build/$NAME"
+  mkdir -p "$DIR"
 
   # figure out MCU type
   ATTINY=$(grep 'ATTINY:' $TARGET | awk '{ print $3 }')
   if [ -z "$ATTINY" ]; then ATTINY=85 ; fi
 
   # try to compile
-  echo ../../../bin/build.sh $ATTINY "$UI" "-DCONFIGFILE=${TARGET}"
-  ../../../bin/build.sh $ATTINY "$UI" "-DCONFIGFILE=${TARGET}"
+  (
+    echo ../../../bin/build.sh $ATTINY "$UI" "-DCONFIGFILE=${TARGET}"
+    BUILD_DIR="$DIR" ../../../bin/build.sh $ATTINY "$UI" "-DCONFIGFILE=${TARGET}"
+  ) > "$DIR/log" 2>&1
 
-  # track result, and rename compiled files
+  # track result, and copy compiled files
   if [ 0 = $? ] ; then
-    mv -f "$UI".hex "$UI".$NAME.hex
-    PASS=$(($PASS + 1))
-    PASSED="$PASSED $NAME"
+    STATUS=built
+    grep -q 'is up to date$' "$DIR/log" && STATUS=unchanged
+    cp -f "$DIR/$UI".hex "$UI".$NAME.hex
+    SIZES=$(avr-size -A "$DIR/$UI".elf | awk '
+      $1 == ".text" { text = $2 }
+      $1 == ".data" { data = $2 }
+      $1 == ".bss" || $1 == ".noinit" { bss += $2 }
+      END { print text + data, data + bss }')
   else
-    echo "ERROR: build failed"
-    FAIL=$(($FAIL + 1))
-    FAILED="$FAILED $NAME"
+    echo "ERROR: build failed" >> "$DIR/log"
+    STATUS=failed
+    SIZES="- -"
   fi
+  echo "$NAME $STATUS $SIZES" > "$DIR/result"
+
+  # (all at once, so parallel builds don't mix their output together)
+  echo "===== $NAME =====
+$(cat "$DIR/log")"
+  exit 0
+fi
 
-done
+JOBS=$(getconf _NPROCESSORS_ONLN 2> /dev/null || echo 1)
+if [ "-j" = "$1" ]; then
+  JOBS="$2" ; shift ; shift
+fi
+
+if [ ! -z "$1" ]; then
+  SEARCH="$1"
+fi
+
+# (only touch version.h when the date changes, or everything would rebuild)
+date '+#define VERSION_NUMBER "%Y%m%d"' > version.h.new
+if cmp -s version.h.new version.h ; then rm -f version.h.new
+else mv -f version.h.new version.h ; fi
+
+mkdir -p build
+rm -f build/*/result
+
+for TARGET in cfg-*.h ; do
+  # maybe limit builds to a specific pattern
+  if [ ! -z "$SEARCH" ]; then
+    echo "$TARGET" | grep -i "$SEARCH" > /dev/null
+    if [ 0 != $? ]; then continue ; fi
+  fi
+  echo "$TARGET"
+done | xargs -n 1 -P "$JOBS" sh "$0" --one
 
 # summary
+cat build/*/result 2> /dev/null | sort > build/summary.txt
+PASS=$(grep -cv ' failed ' build/summary.txt)
+FAIL=$(grep -c ' failed ' build/summary.txt)
+FAILED=$(awk '$2 == "failed" { printf " %s", $1 }' build/summary.txt)
+
 echo "===== $PASS builds succeeded, $FAIL failed ====="
-#echo "PASS: $PASSED"
 if [ 0 != $FAIL ]; then
   echo "FAIL:$FAILED"
 fi
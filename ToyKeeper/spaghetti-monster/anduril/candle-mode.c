@@ -67,6 +67,7 @@ uint8_t candle_mode_state(Event event, uint16_t arg) {
         // parent state just rotated through strobe/flasher modes,
         // so cancel timer...  in case any time was left over from earlier
         sunset_timer = 0;
+        timer_stop(TIMER_SUNSET);
         return MISCHIEF_MANAGED;
     }
     #endif  // ifdef USE_SUNSET_TIMER
@@ -98,7 +99,8 @@ uint8_t candle_mode_state(Event event, uint16_t arg) {
     // clock tick: animate candle brightness
     else if (event == EV_tick) {
         // un-reverse after 1 second
-        if (arg == AUTO_REVERSE_TIME) ramp_direction = 1;
+        // (ticks can arrive several at once, so don't wait for an exact match)
+        if (arg >= AUTO_REVERSE_TIME) ramp_direction = 1;
 
         // 3-oscillator synth for a relatively organic pattern
         uint8_t add;
@@ -111,7 +113,7 @@ uint8_t candle_mode_state(Event event, uint16_t arg) {
         #ifdef USE_SUNSET_TIMER
         if (1 == sunset_timer) {
             brightness = brightness
-                         * ((TICKS_PER_MINUTE>>5) - (sunset_ticks>>5))
+                         * (timer_remaining(TIMER_SUNSET)>>5)
                          / (TICKS_PER_MINUTE>>5);
         }
         #endif  // ifdef USE_SUNSET_TIMER
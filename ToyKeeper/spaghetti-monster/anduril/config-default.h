@@ -65,6 +65,11 @@
 #define B_TIMING_ON B_RELEASE_T
 #define B_TIMING_OFF B_TIMEOUT_T
 
+// learn how fast the user multi-clicks, and don't wait much longer than
+// that before deciding a click was just a single click
+// (makes B_TIMEOUT_T actions faster, and is saved in eeprom)
+#define USE_ADAPTIVE_RELEASE_TIMEOUT
+
 // default ramp style: 0 = smooth, 1 = stepped
 #define RAMP_STYLE 0
 
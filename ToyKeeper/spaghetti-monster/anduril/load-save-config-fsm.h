@@ -95,6 +95,9 @@ typedef enum {
     #ifdef USE_AUTOLOCK
     autolock_time_e,
     #endif
+    #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+    release_timeout_e,
+    #endif
     eeprom_indexes_e_END
 } eeprom_indexes_e;
 #define EEPROM_BYTES eeprom_indexes_e_END
@@ -95,7 +95,18 @@ void load_config() {
         #ifdef USE_AUTOLOCK
         autolock_time = eeprom[autolock_time_e];
         #endif
+        #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+        // (ignore garbage from older firmware)
+        uint8_t rt = eeprom[release_timeout_e];
+        if ((rt >= RELEASE_TIMEOUT_FLOOR) && (rt <= RELEASE_TIMEOUT_CEIL))
+            release_timeout = rt;
+        #endif
     }
+    #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+    // off mode saves when this differs, so only a learned change counts
+    // (not a blank eeprom, or garbage from older firmware)
+    eeprom[release_timeout_e] = release_timeout;
+    #endif
     #ifdef START_AT_MEMORIZED_LEVEL
     if (load_eeprom_wl()) {
         memorized_level = eeprom_wl[0];
@@ -174,6 +185,9 @@ void save_config() {
     #ifdef USE_AUTOLOCK
     eeprom[autolock_time_e] = autolock_time;
     #endif
+    #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+    eeprom[release_timeout_e] = release_timeout;
+    #endif
 
     save_eeprom();
 }
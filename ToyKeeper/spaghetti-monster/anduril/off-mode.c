@@ -28,9 +28,35 @@
 
 uint8_t off_state(Event event, uint16_t arg) {
 
+    #if defined(USE_MANUAL_MEMORY_TIMER) || defined(USE_AUTOLOCK)
+    // count "off for N minutes" from the last button activity,
+    // so clicks which stay in off mode restart the countdown
+    if ((event == EV_enter_state) || (event & B_CLICK)) {
+        #ifdef USE_MANUAL_MEMORY_TIMER
+        // reset to manual memory level after being off for N minutes
+        timer_set(TIMER_MANUAL_MEMORY,
+                  manual_memory_timer * SLEEP_TICKS_PER_MINUTE + 1,
+                  TIMER_SLEEP);
+        #endif
+        #ifdef USE_AUTOLOCK
+        // lock the light after being off for N minutes
+        if (autolock_time > 0) {
+            timer_set(TIMER_AUTOLOCK,
+                      autolock_time * SLEEP_TICKS_PER_MINUTE + 1,
+                      TIMER_SLEEP);
+        }
+        else timer_stop(TIMER_AUTOLOCK);
+        #endif
+    }
+    #endif
+
     // turn emitter off when entering state
     if (event == EV_enter_state) {
         set_level(0);
+        #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+        // remember how fast the user clicks, if it changed
+        if (eeprom[release_timeout_e] != release_timeout) save_config();
+        #endif
         #ifdef USE_INDICATOR_LED
         indicator_led(indicator_led_mode & 0x03);
         #elif defined(USE_AUX_RGB_LEDS)
@@ -38,6 +64,7 @@ uint8_t off_state(Event event, uint16_t arg) {
         #endif
         #ifdef USE_SUNSET_TIMER
         sunset_timer = 0;  // needs a reset in case previous timer was aborted
+        timer_stop(TIMER_SUNSET);
         #endif
         // sleep while off  (lower power use)
         // (unless delay requested; give the ADC some time to catch up)
@@ -59,30 +86,33 @@ uint8_t off_state(Event event, uint16_t arg) {
     #if defined(TICK_DURING_STANDBY)
     // blink the indicator LED, maybe
     else if (event == EV_sleep_tick) {
+        #ifdef USE_INDICATOR_LED
+        if ((indicator_led_mode & 0b00000011) == 0b00000011) {
+            indicator_blink(arg);
+        }
+        #elif defined(USE_AUX_RGB_LEDS)
+        rgb_led_update(rgb_led_off_mode, arg);
+        #endif
+        return MISCHIEF_MANAGED;
+    }
+    #endif
+    #if defined(USE_MANUAL_MEMORY_TIMER) || defined(USE_AUTOLOCK)
+    // been off for a while
+    else if (event == EV_timer) {
         #ifdef USE_MANUAL_MEMORY_TIMER
         // reset to manual memory level when timer expires
-        if (manual_memory &&
-                (arg >= (manual_memory_timer * SLEEP_TICKS_PER_MINUTE))) {
+        if ((arg == TIMER_MANUAL_MEMORY) && manual_memory) {
             memorized_level = manual_memory;
             #ifdef USE_TINT_RAMPING
             tint = manual_memory_tint;
             #endif
         }
         #endif
-        #ifdef USE_INDICATOR_LED
-        if ((indicator_led_mode & 0b00000011) == 0b00000011) {
-            indicator_blink(arg);
-        }
-        #elif defined(USE_AUX_RGB_LEDS)
-        rgb_led_update(rgb_led_off_mode, arg);
-        #endif
-
         #ifdef USE_AUTOLOCK
-            // lock the light after being off for N minutes
-            uint16_t ticks = autolock_time * SLEEP_TICKS_PER_MINUTE;
-            if ((autolock_time > 0)  && (arg > ticks)) {
-                set_state(lockout_state, 0);
-            }
+        // lock the light after being off for N minutes
+        if (arg == TIMER_AUTOLOCK) {
+            set_state(lockout_state, 0);
+        }
         #endif  // ifdef USE_AUTOLOCK
         return MISCHIEF_MANAGED;
     }
@@ -258,7 +258,8 @@ uint8_t steady_state(Event event, uint16_t arg) {
 
     else if (event == EV_tick) {
         // un-reverse after 1 second
-        if (arg == AUTO_REVERSE_TIME) ramp_direction = 1;
+        // (ticks can arrive several at once, so don't wait for an exact match)
+        if (arg >= AUTO_REVERSE_TIME) ramp_direction = 1;
 
         #ifdef USE_SUNSET_TIMER
         // reduce output if shutoff timer is active
@@ -275,9 +276,17 @@ uint8_t steady_state(Event event, uint16_t arg) {
         #endif  // ifdef USE_SUNSET_TIMER
 
         #ifdef USE_SET_LEVEL_GRADUALLY
+        // target changed?  start adjusting  (the timer does the rest)
+        if ((gradual_target != actual_level) && (! timer_active(TIMER_GRADUAL)))
+            timer_set(TIMER_GRADUAL, 1, TIMER_ONESHOT);
+        #endif
+        return MISCHIEF_MANAGED;
+    }
+
+    #ifdef USE_SET_LEVEL_GRADUALLY
+    // time for another small brightness adjustment
+    else if ((event == EV_timer) && (arg == TIMER_GRADUAL)) {
         int16_t diff = gradual_target - actual_level;
-        static uint16_t ticks_since_adjust = 0;
-        ticks_since_adjust++;
         if (diff) {
             uint16_t ticks_per_adjust = 256;
             if (diff < 0) {
@@ -297,15 +306,13 @@ uint8_t steady_state(Event event, uint16_t arg) {
                 //diff >>= 1;
                 diff /= 2;  // because shifting produces weird behavior
             }
-            if (ticks_since_adjust > ticks_per_adjust)
-            {
-                gradual_tick();
-                ticks_since_adjust = 0;
-            }
+            gradual_tick();
+            // wait a while before the next step
+            timer_set(TIMER_GRADUAL, ticks_per_adjust + 1, TIMER_ONESHOT);
         }
-        #endif  // ifdef USE_SET_LEVEL_GRADUALLY
         return MISCHIEF_MANAGED;
     }
+    #endif  // ifdef USE_SET_LEVEL_GRADUALLY
 
     #ifdef USE_THERMAL_REGULATION
     // overheating: drop by an amount proportional to how far we are above the ceiling
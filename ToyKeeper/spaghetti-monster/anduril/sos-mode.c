@@ -44,30 +44,36 @@ uint8_t sos_state(Event event, uint16_t arg) {
 }
 #endif
 
-void sos_blink(uint8_t num, uint8_t dah) {
+uint8_t sos_blink(Coroutine *co, uint8_t num, uint8_t dah) {
     #define DIT_LENGTH 200
-    for (; num > 0; num--) {
+    static uint8_t blinks;
+    CO_BEGIN(co);
+    for (blinks = num; blinks > 0; blinks--) {
         set_level(memorized_level);
-        nice_delay_ms(DIT_LENGTH);
+        CO_SLEEP_MS(co, DIT_LENGTH);
         if (dah) {  // dah is 3X as long as a dit
-            nice_delay_ms(DIT_LENGTH*2);
+            CO_SLEEP_MS(co, DIT_LENGTH*2);
         }
         set_level(0);
         // one "off" dit between blinks
-        nice_delay_ms(DIT_LENGTH);
+        CO_SLEEP_MS(co, DIT_LENGTH);
     }
     // three "off" dits (or one "dah") between letters
     // (except for SOS, which is collectively treated as a single "letter")
     //nice_delay_ms(DIT_LENGTH*2);
+    CO_END(co);
 }
 
-inline void sos_mode_iter() {
-    // one iteration of main loop()
+uint8_t sos_mode_iter(Coroutine *co) {
+    // one SOS per call
+    static Coroutine blink_co;
+    CO_BEGIN(co);
     //nice_delay_ms(1000);
-    sos_blink(3, 0);  // S
-    sos_blink(3, 1);  // O
-    sos_blink(3, 0);  // S
-    nice_delay_ms(2000);
+    CO_CALL(co, &blink_co, sos_blink(&blink_co, 3, 0));  // S
+    CO_CALL(co, &blink_co, sos_blink(&blink_co, 3, 1));  // O
+    CO_CALL(co, &blink_co, sos_blink(&blink_co, 3, 0));  // S
+    CO_SLEEP_MS(co, 2000);
+    CO_END(co);
 }
 
 
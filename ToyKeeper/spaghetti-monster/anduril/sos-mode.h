@@ -24,6 +24,8 @@
 // automatic SOS emergency signal
 uint8_t sos_state(Event event, uint16_t arg);
 #endif
+uint8_t sos_blink(Coroutine *co, uint8_t num, uint8_t dah);
+uint8_t sos_mode_iter(Coroutine *co);
 
 
 #endif
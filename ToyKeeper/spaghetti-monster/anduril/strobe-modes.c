@@ -153,7 +153,8 @@ uint8_t strobe_state(Event event, uint16_t arg) {
     // clock tick: bump the random seed
     else if (event == EV_tick) {
         // un-reverse after 1 second
-        if (arg == AUTO_REVERSE_TIME) ramp_direction = 1;
+        // (ticks can arrive several at once, so don't wait for an exact match)
+        if (arg >= AUTO_REVERSE_TIME) ramp_direction = 1;
 
         pseudo_rand_seed += arg;
         return MISCHIEF_MANAGED;
@@ -163,7 +164,7 @@ uint8_t strobe_state(Event event, uint16_t arg) {
 }
 
 // runs repeatedly in FSM loop() whenever UI is in strobe_state or momentary strobe
-inline void strobe_state_iter() {
+uint8_t strobe_state_iter(Coroutine *co) {
     uint8_t st = strobe_type;  // can't use switch() on an enum
 
     switch(st) {
@@ -174,57 +175,60 @@ inline void strobe_state_iter() {
         #ifdef USE_TACTICAL_STROBE_MODE
         case tactical_strobe_e:
         #endif
-            party_tactical_strobe_mode_iter(st);
-            break;
+            return party_tactical_strobe_mode_iter(co, st);
         #endif
 
         #ifdef USE_LIGHTNING_MODE
         case lightning_storm_e:
-            lightning_storm_iter();
-            break;
+            return lightning_storm_iter(co);
         #endif
 
         #ifdef USE_BIKE_FLASHER_MODE
         case bike_flasher_e:
-            bike_flasher_iter();
-            break;
+            return bike_flasher_iter(co);
         #endif
     }
+    // candle mode runs from clock ticks, so doze until the next one
+    return CO_IDLE;
 }
 #endif  // ifdef USE_STROBE_STATE
 
 #if defined(USE_PARTY_STROBE_MODE) || defined(USE_TACTICAL_STROBE_MODE)
-inline void party_tactical_strobe_mode_iter(uint8_t st) {
-    // one iteration of main loop()
+uint8_t party_tactical_strobe_mode_iter(Coroutine *co, uint8_t st) {
+    // one flash per call  (uses precise delays, to keep the rhythm steady)
     uint8_t del = strobe_delays[st];
+    CO_BEGIN(co);
     // TODO: make tac strobe brightness configurable?
     set_level(STROBE_BRIGHTNESS);
     if (0) {}  // placeholde0
     #ifdef USE_PARTY_STROBE_MODE
     else if (st == party_strobe_e) {  // party strobe
         #ifdef PARTY_STROBE_ONTIME
-        nice_delay_ms(PARTY_STROBE_ONTIME);
+        CO_DELAY_MS(co, PARTY_STROBE_ONTIME);
         #else
         if (del < 42) delay_zero();
-        else nice_delay_ms(1);
+        else CO_DELAY_MS(co, 1);
         #endif
     }
     #endif
     #ifdef USE_TACTICAL_STROBE_MODE
     else {  //tactical strobe
-        nice_delay_ms(del >> 1);
+        CO_DELAY_MS(co, del >> 1);
     }
     #endif
     set_level(STROBE_OFF_LEVEL);
-    nice_delay_ms(del);  // no return check necessary on final delay
+    CO_DELAY_MS(co, del);
+    CO_END(co);
 }
 #endif
 
 #ifdef USE_LIGHTNING_MODE
-inline void lightning_storm_iter() {
-    // one iteration of main loop()
-    int16_t brightness;
-    uint16_t rand_time;
+uint8_t lightning_storm_iter(Coroutine *co) {
+    // one lightning strike per call
+    static int16_t brightness;
+    static uint16_t rand_time;
+    static uint8_t stepdown;
+    CO_BEGIN(co);
 
     // turn the emitter on at a random level,
     // for a random amount of time between 1ms and 32ms
@@ -235,13 +239,13 @@ inline void lightning_storm_iter() {
     brightness += pseudo_rand() % brightness;  // 2 to 159 now (w/ low bias)
     if (brightness > MAX_LEVEL) brightness = MAX_LEVEL;
     set_level(brightness);
-    nice_delay_ms(rand_time);
+    CO_DELAY_MS(co, rand_time);
 
     // decrease the brightness somewhat more gradually, like lightning
-    uint8_t stepdown = brightness >> 3;
+    stepdown = brightness >> 3;
     if (stepdown < 1) stepdown = 1;
     while(brightness > 1) {
-        nice_delay_ms(rand_time);
+        CO_DELAY_MS(co, rand_time);
         brightness -= stepdown;
         if (brightness < 0) brightness = 0;
         set_level(brightness);
@@ -252,7 +256,7 @@ inline void lightning_storm_iter() {
            }
            */
         if (! (pseudo_rand() & 3)) {
-            nice_delay_ms(rand_time);
+            CO_DELAY_MS(co, rand_time);
             set_level(brightness>>1);
         }
     }
@@ -263,23 +267,27 @@ inline void lightning_storm_iter() {
     rand_time = 1 << (pseudo_rand() % 13);
     rand_time += pseudo_rand() % rand_time;
     set_level(0);
-    nice_delay_ms(rand_time);  // no return check necessary on final delay
+    CO_SLEEP_MS(co, rand_time);
+    CO_END(co);
 }
 #endif
 
 #ifdef USE_BIKE_FLASHER_MODE
-inline void bike_flasher_iter() {
-    // one iteration of main loop()
+uint8_t bike_flasher_iter(Coroutine *co) {
+    // one group of flashes per call
+    static uint8_t i;
     uint8_t burst = bike_flasher_brightness << 1;
     if (burst > MAX_LEVEL) burst = MAX_LEVEL;
-    for(uint8_t i=0; i<4; i++) {
+    CO_BEGIN(co);
+    for(i=0; i<4; i++) {
         set_level(burst);
-        nice_delay_ms(5);
+        CO_DELAY_MS(co, 5);
         set_level(bike_flasher_brightness);
-        nice_delay_ms(65);
+        CO_DELAY_MS(co, 65);
     }
-    nice_delay_ms(720);  // no return check necessary on final delay
+    CO_SLEEP_MS(co, 720);
     set_level(0);
+    CO_END(co);
 }
 #endif
 
@@ -72,24 +72,24 @@ strobe_mode_te strobe_type = 0;
 // party and tactical strobes
 #ifdef USE_STROBE_STATE
 uint8_t strobe_state(Event event, uint16_t arg);
-inline void strobe_state_iter();
+uint8_t strobe_state_iter(Coroutine *co);
 #endif
 
 #if defined(USE_PARTY_STROBE_MODE) || defined(USE_TACTICAL_STROBE_MODE)
 // party / tactical strobe timing
 uint8_t strobe_delays[] = { 41, 67 };  // party strobe 24 Hz, tactical strobe 10 Hz
-inline void party_tactical_strobe_mode_iter(uint8_t st);
+uint8_t party_tactical_strobe_mode_iter(Coroutine *co, uint8_t st);
 #endif
 
 #ifdef USE_LIGHTNING_MODE
-inline void lightning_storm_iter();
+uint8_t lightning_storm_iter(Coroutine *co);
 #endif
 
 // bike mode config options
 #ifdef USE_BIKE_FLASHER_MODE
 #define MAX_BIKING_LEVEL 120  // should be 127 or less
 uint8_t bike_flasher_brightness = MAX_1x7135;
-inline void bike_flasher_iter();
+uint8_t bike_flasher_iter(Coroutine *co);
 #endif
 
 #ifdef USE_CANDLE_MODE
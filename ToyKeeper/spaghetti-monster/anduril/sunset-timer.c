@@ -32,7 +32,7 @@ uint8_t sunset_timer_state(Event event, uint16_t arg) {
     // reset on start
     if (event == EV_enter_state) {
         sunset_timer = 0;
-        sunset_ticks = 0;
+        timer_stop(TIMER_SUNSET);
         return MISCHIEF_MANAGED;
     }
     // hold: maybe "bump" the timer if it's active and almost expired
@@ -50,24 +50,20 @@ uint8_t sunset_timer_state(Event event, uint16_t arg) {
                 // add a few minutes to the timer
                 sunset_timer += SUNSET_TIMER_UNIT;
                 sunset_timer_peak = sunset_timer;  // reset ceiling
-                sunset_ticks = 0;  // reset phase
+                // reset phase, and count down once per minute
+                timer_set(TIMER_SUNSET, TICKS_PER_MINUTE, TIMER_PERIODIC);
                 // let the user know something happened
                 blink_once();
             }
         }
         return MISCHIEF_MANAGED;
     }
-    // tick: count down until time expires
-    else if (event == EV_tick) {
-        // time passed
-        sunset_ticks ++;
-        // did we reach a minute mark?
-        if (sunset_ticks >= TICKS_PER_MINUTE) {
-            sunset_ticks = 0;
-            if (sunset_timer > 0) {
-                sunset_timer --;
-            }
+    // a minute passed: count down until time expires
+    else if ((event == EV_timer) && (arg == TIMER_SUNSET)) {
+        if (sunset_timer > 0) {
+            sunset_timer --;
         }
+        if (! sunset_timer) timer_stop(TIMER_SUNSET);
         return MISCHIEF_MANAGED;
     }
     return EVENT_NOT_HANDLED;
@@ -28,7 +28,7 @@
 // automatic shutoff timer
 uint8_t sunset_timer = 0;  // minutes remaining in countdown
 uint8_t sunset_timer_peak = 0;  // total minutes in countdown
-uint16_t sunset_ticks = 0;  // counts from 0 to TICKS_PER_MINUTE, then repeats
+// (minutes are counted by the TIMER_SUNSET software timer)
 uint8_t sunset_timer_state(Event event, uint16_t arg);
 
 
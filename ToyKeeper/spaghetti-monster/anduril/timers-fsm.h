@@ -0,0 +1,46 @@
+/*
+ * timers-fsm.h: FSM config for software timers in Anduril.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMERS_FSM_H
+#define TIMERS_FSM_H
+
+// figure out how many timer slots are needed,
+// based on which UI features are enabled
+typedef enum {
+    #ifdef USE_SET_LEVEL_GRADUALLY
+    TIMER_GRADUAL,        // spacing between gradual brightness adjustments
+    #endif
+    #ifdef USE_SUNSET_TIMER
+    TIMER_SUNSET,         // once per minute while sunset timer is active
+    #endif
+    #ifdef USE_AUTOLOCK
+    TIMER_AUTOLOCK,       // lock after being off for N minutes
+    #endif
+    #ifdef USE_MANUAL_MEMORY_TIMER
+    TIMER_MANUAL_MEMORY,  // reset to manual mem after being off for N minutes
+    #endif
+    NUM_TIMERS
+} timer_id_e;
+
+#if defined(USE_SET_LEVEL_GRADUALLY) || defined(USE_SUNSET_TIMER) || defined(USE_AUTOLOCK) || defined(USE_MANUAL_MEMORY_TIMER)
+#define USE_TIMERS
+#endif
+
+
+#endif
@@ -0,0 +1,395 @@
+/*
+ * bench-avr.c: Counts cycles in an FSM firmware, using simavr.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Usage:
+//   bench-avr -m attiny85 -F 8000000 -s syms.txt [options] fw.elf script
+// Options:
+//   -f NAME        profile this function  (repeat for more)
+//   -b B3          button pin  (port letter and bit)
+//   -T OFFSET      THERM_CAL_OFFSET, for internal temperature readings
+//   -D CH:SLOPE:OFFSET
+//                  voltage divider on ADC channel CH, in mV at the pin
+//                  per volt of battery, plus an offset in mV
+//   -p             only check whether simavr knows this MCU
+// The symbol file has "address size name" lines, for text symbols
+// (from avr-nm).  The script uses the same commands as sim/sim-run.c.
+//
+// Prints one line per result, for bench.py:
+//   fn NAME calls min avg max           (cycles, not counting interrupts)
+//   isr NAME calls min avg max lat_avg lat_max
+//   cli OWNER count max                 (longest interrupts-off windows)
+//   total cycles
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sim_avr.h>
+#include <sim_core.h>
+#include <sim_elf.h>
+#include <sim_interrupts.h>
+#include <avr_ioport.h>
+#include <avr_adc.h>
+
+#define MAX_SYMS 1024
+#define MAX_FUNCS 32
+#define MAX_DEPTH 64
+#define CLICK_MS 40
+
+typedef struct Sym {
+    uint32_t addr, size;
+    char name[48];
+    // stats, if this one is profiled
+    uint8_t tracked, isr;
+    uint32_t calls;
+    uint64_t total, min, max;
+    uint64_t lat_total, lat_max;
+    // interrupts-off windows started here
+    uint32_t cli_count;
+    uint64_t cli_max;
+} Sym;
+
+typedef struct Frame {
+    Sym *sym;
+    uint16_t sp;
+    avr_cycle_count_t start;
+    avr_cycle_count_t excluded;  // isr_cycles at start
+} Frame;
+
+static avr_t *avr;
+static uint32_t f_cpu;
+static Sym syms[MAX_SYMS];
+static int num_syms;
+static Sym **entry;  // flash word -> tracked symbol starting there
+static Frame stack[MAX_DEPTH];
+static int depth;
+static avr_cycle_count_t isr_cycles;  // time spent in ISRs so far
+static avr_cycle_count_t pending_since, cli_since;
+static Sym *cli_owner;
+static uint8_t last_i, booted;
+static uint32_t prev_pc;
+
+// ADC inputs
+static avr_irq_t *button_irq;
+static int therm_cal = 0;
+static int div_ch = -1;
+static double div_slope, div_offset;
+static double volts = 4.0, celsius = 25.0;
+
+
+//////////  symbols  //////////
+
+static Sym *find_sym(const char *name) {
+    for (int i=0; i<num_syms; i++)
+        if (! strcmp(syms[i].name, name)) return &syms[i];
+    return NULL;
+}
+
+static Sym *sym_at(uint32_t addr) {
+    for (int i=0; i<num_syms; i++)
+        if ((addr >= syms[i].addr) && (addr < syms[i].addr + syms[i].size))
+            return &syms[i];
+    return NULL;
+}
+
+static void load_syms(const char *path) {
+    FILE *f = fopen(path, "r");
+    char name[256];
+    unsigned int addr, size;
+    if (! f) { perror(path); exit(2); }
+    while ((num_syms < MAX_SYMS)
+           && (fscanf(f, "%x %x %255s", &addr, &size, name) == 3)) {
+        Sym *s = &syms[num_syms++];
+        s->addr = addr;
+        s->size = size;
+        strncpy(s->name, name, sizeof(s->name)-1);
+        s->min = ~0ULL;
+        // ISR bodies are always profiled
+        if (! strncmp(name, "__vector_", 9)) s->tracked = s->isr = 1;
+    }
+    fclose(f);
+}
+
+
+//////////  inputs  //////////
+
+static void set_inputs(void) {
+    avr->vcc = avr->avcc = (uint32_t)(volts * 1000);
+    if (div_ch >= 0)
+        avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0 + div_ch),
+                      (uint32_t)(volts * div_slope + div_offset));
+    // the firmware reads (raw - 275 + THERM_CAL_OFFSET) as Celsius,
+    // against the 1.1V reference
+    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_TEMP),
+                  (uint32_t)((celsius + 275 - therm_cal) * 1100 / 1024));
+}
+
+static void button(int pressed) {
+    if (button_irq) avr_raise_irq(button_irq, pressed ? 0 : 1);
+}
+
+
+//////////  profiling  //////////
+
+static void end_frame(avr_cycle_count_t now) {
+    Frame *fr = &stack[--depth];
+    Sym *s = fr->sym;
+    uint64_t t = now - fr->start;
+    if (s->isr) isr_cycles += t;
+    else t -= isr_cycles - fr->excluded;
+    s->calls ++;
+    s->total += t;
+    if (t < s->min) s->min = t;
+    if (t > s->max) s->max = t;
+}
+
+// runs after every instruction
+static void observe(void) {
+    uint32_t pc = avr->pc;
+    uint16_t sp = avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+    avr_cycle_count_t now = avr->cycle;
+    uint8_t i_flag = avr->sreg[S_I];
+    Sym *s;
+
+    // returned?  (the stack pointer is back above the frame's start)
+    while (depth && (sp > stack[depth-1].sp)) end_frame(now);
+
+    // entered a profiled function?  (from somewhere else)
+    s = entry[pc >> 1];
+    if (s && ((prev_pc < s->addr) || (prev_pc >= s->addr + s->size))
+          && (depth < MAX_DEPTH)) {
+        Frame *fr = &stack[depth++];
+        fr->sym = s;
+        fr->sp = sp;
+        fr->start = now;
+        fr->excluded = isr_cycles;
+        if (s->isr && pending_since) {
+            uint64_t lat = now - pending_since;
+            s->lat_total += lat;
+            if (lat > s->lat_max) s->lat_max = lat;
+            pending_since = 0;
+        }
+    }
+
+    // interrupt latency counts from the first moment one is pending
+    if (avr_has_pending_interrupts(avr)) {
+        if (! pending_since) pending_since = now;
+    }
+    else pending_since = 0;
+
+    // interrupts-off windows  (ignoring boot, before the first sei)
+    if (i_flag != last_i) {
+        if (! i_flag) {
+            cli_since = now;
+            // (an ISR entry clears it too)
+            cli_owner = (s && s->isr) ? s : sym_at(prev_pc);
+        }
+        else if (booted && cli_owner) {
+            uint64_t t = now - cli_since;
+            cli_owner->cli_count ++;
+            if (t > cli_owner->cli_max) cli_owner->cli_max = t;
+        }
+        else booted = 1;
+        last_i = i_flag;
+    }
+
+    prev_pc = pc;
+}
+
+static void run_until(avr_cycle_count_t until) {
+    while (avr->cycle < until) {
+        int state = avr_run(avr);
+        if ((state == cpu_Done) || (state == cpu_Crashed)) {
+            fprintf(stderr, "simulation stopped  (state %d)\n", state);
+            exit(2);
+        }
+        observe();
+    }
+}
+
+static void run_ms(double ms) {
+    run_until(avr->cycle + (avr_cycle_count_t)(ms * f_cpu / 1000));
+}
+
+
+//////////  script  //////////
+
+static double parse_ms(const char *s) {
+    char *end;
+    double t = strtod(s, &end);
+    if (! strcmp(end, "s")) t *= 1000;
+    else if (! strcmp(end, "m")) t *= 60*1000;
+    else if (! strcmp(end, "h")) t *= 60*60*1000;
+    else if (strcmp(end, "ms") && *end) {
+        fprintf(stderr, "bad time: %s\n", s);
+        exit(2);
+    }
+    return t;
+}
+
+static void run_script(FILE *f) {
+    char w[64], a[64];
+    while (fscanf(f, " %63s", w) == 1) {
+        if (w[0] == '#') {
+            int c;
+            while (((c = getc(f)) != EOF) && (c != '\n')) {}
+        }
+        else if (! strcmp(w, "press")) button(1);
+        else if (! strcmp(w, "release")) button(0);
+        else if ((! strcmp(w, "wait")) && (fscanf(f, " %63s", a) == 1))
+            run_ms(parse_ms(a));
+        else if ((! strcmp(w, "hold")) && (fscanf(f, " %63s", a) == 1)) {
+            button(1);
+            run_ms(parse_ms(a));
+            button(0);
+        }
+        else if (! strcmp(w, "click")) {
+            // (count is optional, so peek at the next word)
+            int n = 1, c;
+            fscanf(f, " ");
+            c = getc(f);
+            ungetc(c, f);
+            if ((c >= '0') && (c <= '9') && (fscanf(f, "%d", &n) != 1)) n = 1;
+            for (int i=0; i<n; i++) {
+                if (i) run_ms(CLICK_MS);
+                button(1);
+                run_ms(CLICK_MS);
+                button(0);
+            }
+        }
+        else if ((! strcmp(w, "volts")) && (fscanf(f, " %63s", a) == 1)) {
+            volts = atof(a);
+            set_inputs();
+        }
+        else if ((! strcmp(w, "temp")) && (fscanf(f, " %63s", a) == 1)) {
+            celsius = atof(a);
+            set_inputs();
+        }
+        else {
+            fprintf(stderr, "bad command: %s\n", w);
+            exit(2);
+        }
+    }
+}
+
+
+//////////  main  //////////
+
+static void report(void) {
+    for (int i=0; i<num_syms; i++) {
+        Sym *s = &syms[i];
+        if (s->tracked && s->calls) {
+            if (s->isr)
+                printf("isr %s %u %llu %llu %llu %llu %llu\n", s->name, s->calls,
+                       (unsigned long long)s->min,
+                       (unsigned long long)(s->total / s->calls),
+                       (unsigned long long)s->max,
+                       (unsigned long long)(s->lat_total / s->calls),
+                       (unsigned long long)s->lat_max);
+            else
+                printf("fn %s %u %llu %llu %llu\n", s->name, s->calls,
+                       (unsigned long long)s->min,
+                       (unsigned long long)(s->total / s->calls),
+                       (unsigned long long)s->max);
+        }
+        else if (s->tracked)
+            printf("fn %s 0 0 0 0\n", s->name);
+        if (s->cli_count)
+            printf("cli %s %u %llu\n", s->name, s->cli_count,
+                   (unsigned long long)s->cli_max);
+    }
+    printf("total %llu\n", (unsigned long long)avr->cycle);
+}
+
+int main(int argc, char **argv) {
+    const char *mcu = NULL, *symfile = NULL;
+    const char *funcs[MAX_FUNCS];
+    int num_funcs = 0, probe = 0, opt;
+    char button_port = 0;
+    int button_bit = 0;
+    elf_firmware_t fw;
+    FILE *script;
+
+    for (opt=1; (opt < argc) && (argv[opt][0] == '-'); opt++) {
+        char *a = argv[opt];
+        if (! strcmp(a, "-p")) { probe = 1; continue; }
+        if (opt+1 >= argc) break;
+        if (! strcmp(a, "-m")) mcu = argv[++opt];
+        else if (! strcmp(a, "-F")) f_cpu = strtoul(argv[++opt], NULL, 0);
+        else if (! strcmp(a, "-s")) symfile = argv[++opt];
+        else if (! strcmp(a, "-f") && (num_funcs < MAX_FUNCS)) funcs[num_funcs++] = argv[++opt];
+        else if (! strcmp(a, "-T")) therm_cal = atoi(argv[++opt]);
+        else if (! strcmp(a, "-b")) {
+            a = argv[++opt];
+            button_port = a[0];
+            button_bit = atoi(a+1);
+        }
+        else if (! strcmp(a, "-D")) {
+            if (sscanf(argv[++opt], "%d:%lf:%lf", &div_ch, &div_slope, &div_offset) != 3) {
+                fprintf(stderr, "bad -D\n");
+                return 2;
+            }
+        }
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+    }
+
+    if (! mcu) { fprintf(stderr, "no MCU (-m)\n"); return 2; }
+    avr = avr_make_mcu_by_name(mcu);
+    if (probe) return avr ? 0 : 1;
+    if (! avr) { fprintf(stderr, "simavr doesn't know %s\n", mcu); return 3; }
+    if ((opt + 2 != argc) || (! symfile) || (! f_cpu)) {
+        fprintf(stderr, "Usage: bench-avr -m MCU -F HZ -s SYMS [options] fw.elf script\n");
+        return 2;
+    }
+
+    memset(&fw, 0, sizeof(fw));
+    if (elf_read_firmware(argv[opt], &fw)) {
+        fprintf(stderr, "can't read %s\n", argv[opt]);
+        return 2;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &fw);
+    // (simavr ignores CLKPR, so this stays fixed)
+    avr->frequency = f_cpu;
+    avr->log = LOG_ERROR;
+
+    // which functions to profile
+    load_syms(symfile);
+    for (int i=0; i<num_funcs; i++) {
+        Sym *s = find_sym(funcs[i]);
+        if (s) s->tracked = 1;
+        else printf("fn %s - - - -\n", funcs[i]);  // inlined or missing
+    }
+    entry = calloc(avr->flashend / 2 + 1, sizeof(Sym *));
+    for (int i=0; i<num_syms; i++)
+        if (syms[i].tracked && (syms[i].addr <= avr->flashend))
+            entry[syms[i].addr >> 1] = &syms[i];
+
+    // inputs
+    if (button_port) {
+        button_irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(button_port), button_bit);
+        button(0);
+    }
+    set_inputs();
+
+    script = strcmp(argv[opt+1], "-") ? fopen(argv[opt+1], "r") : stdin;
+    if (! script) { perror(argv[opt+1]); return 2; }
+    run_script(script);
+    report();
+    return 0;
+}
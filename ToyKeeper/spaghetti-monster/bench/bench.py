@@ -0,0 +1,380 @@
+#!/usr/bin/env python
+
+"""Cycle benchmark for FSM hot paths, using simavr.
+
+Run it from the program's directory:
+
+    ../bench/bench.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the firmware,
+runs bench/scenario.txt in simavr (via bench-avr), and compares the
+cycle counts against bench/baseline.txt.  Anything slower than the
+baseline counts as a regression, and makes the run fail.  So does a
+target which isn't in the baseline yet, since there's nothing to
+compare it to:  run with --update once, on a known-good commit, and
+commit the baseline.
+
+Options:
+    --update        write the results to the baseline instead
+    --tolerance N   allowed slowdown, in percent  (default 1)
+    --scenario F    use a different stimulus script
+    -v              show every result, not just changes
+
+Each target gets built twice:  once as usual, to measure the interrupt
+handlers, interrupt latency, and interrupts-off windows ...  and once
+with -fno-inline, so the hot-path functions have their own symbols.
+Those numbers include a few cycles of call overhead which the real
+build doesn't have.
+
+Needs avr-gcc, avr-nm, and simavr (with its headers, to build bench-avr).
+MCUs which simavr doesn't know (like the attiny1616) are skipped.
+"""
+
+from __future__ import print_function
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+BENCH = os.path.dirname(os.path.abspath(__file__))
+BIN = os.path.join(BENCH, '..', '..', '..', 'bin')
+RUNNER = os.path.join(BENCH, 'bench-avr')
+
+# the hot paths
+FUNCS = ['WDT_inner', 'adc_deferred', 'set_level', 'gradual_tick',
+         'ramp_unpack', 'update_tint', 'emit_now']
+
+TOLERANCE = 1.0  # percent
+SLACK = 2  # cycles, so tiny functions don't trip on rounding
+
+
+def main(args):
+    """Build, run, and compare each target"""
+    opts = {'update': False, 'tolerance': TOLERANCE, 'verbose': False,
+            'scenario': os.path.join(BENCH, 'scenario.txt'),
+            'baseline': os.path.join(BENCH, 'baseline.txt')}
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--update':
+            opts['update'] = True
+        elif arg == '--tolerance':
+            opts['tolerance'] = float(args.pop(0))
+        elif arg == '--scenario':
+            opts['scenario'] = os.path.abspath(args.pop(0))
+        elif arg == '-v':
+            opts['verbose'] = True
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+
+    if not build_runner():
+        return 2
+
+    baseline = load_baseline(opts['baseline'])
+    results = {}
+    skipped = []
+    failed = []
+    out = os.path.join(os.getcwd(), 'bench-out')
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    targets = sorted(t for t in os.listdir('.')
+                     if t.startswith('cfg-') and t.endswith('.h'))
+    for cfg in targets:
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        print('===== %s =====' % name)
+        attiny = mcu_of(cfg)
+        if subprocess.call([RUNNER, '-p', '-m', 'attiny' + attiny]):
+            print('  simavr has no attiny%s, skipped' % attiny)
+            skipped.append(name)
+            continue
+        try:
+            results[name] = bench(cfg, name, attiny, out, opts['scenario'])
+        except BenchError as e:
+            print('  %s' % e)
+            failed.append(name)
+
+    regressions = compare(baseline, results, opts)
+    missing = sorted(t for t in results if t not in baseline)
+
+    if opts['update']:
+        for name in results:
+            baseline[name] = results[name]
+        save_baseline(opts['baseline'], baseline)
+        print('Updated %s' % opts['baseline'])
+        regressions = []
+        missing = []
+
+    print('')
+    print('Benchmarked: %i  Skipped: %s  Failed: %s' % (
+        len(results), ' '.join(skipped) or '-', ' '.join(failed) or '-'))
+    if regressions:
+        print('Regressions:')
+        for r in regressions:
+            print('  ' + r)
+    if missing:
+        print('Not in %s (run with --update first):  %s' % (
+            os.path.basename(opts['baseline']), ' '.join(missing)))
+    if not results:
+        print('Nothing was benchmarked.')
+    if failed or regressions or missing or not results:
+        return 1
+    return 0
+
+
+class BenchError(Exception):
+    pass
+
+
+def run(cmd, **kwargs):
+    """Run a command, and return its output"""
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, **kwargs)
+    text = proc.communicate()[0].decode('utf-8', 'replace')
+    if proc.returncode:
+        raise BenchError('failed: %s\n%s' % (' '.join(cmd), text))
+    return text
+
+
+def build_runner():
+    """Compile bench-avr, if it's missing or older than its source"""
+    src = RUNNER + '.c'
+    if os.path.exists(RUNNER) and \
+            os.path.getmtime(RUNNER) >= os.path.getmtime(src):
+        return True
+    try:
+        flags = run(['pkg-config', '--cflags', '--libs', 'simavr']).split()
+    except (OSError, BenchError):
+        flags = ['-I/usr/include/simavr', '-I/usr/local/include/simavr',
+                 '-lsimavr', '-lelf']
+    try:
+        run(['cc', '-O2', '-o', RUNNER, src] + flags + ['-lelf'])
+    except (OSError, BenchError) as e:
+        print("Can't build bench-avr.  Is simavr installed?")
+        print(e)
+        return False
+    return True
+
+
+def mcu_of(cfg):
+    """Find the MCU type, the same way build-all.sh does"""
+    for line in open(cfg):
+        if 'ATTINY:' in line:
+            return line.split()[2]
+    return '85'
+
+
+def bench(cfg, name, attiny, out, scenario):
+    """Build one target both ways, and return its numbers"""
+    # production build first, since the preprocessor needs its ramp.h
+    elf = build(cfg, name, attiny, out, '')
+    defs = macros(cfg, attiny, ramp_file())
+    common = ['-m', 'attiny' + attiny, '-F', str(int(value(defs, 'F_CPU')))]
+
+    # button
+    port = defs.get('SWITCH_PORT', 'PINB').strip()
+    pin = value(defs, 'SWITCH_PIN')
+    if pin is not None and re.match(r'^PIN[A-C]$', port):
+        common += ['-b', '%s%i' % (port[-1], pin)]
+
+    # voltage divider:  raw = (10*volts - fudge) * (ADC_44 - ADC_22) / 22
+    # ... and simavr wants millivolts at the pin, against 1.1V
+    if 'USE_VOLTAGE_DIVIDER' in defs:
+        k = (value(defs, 'ADC_44') - value(defs, 'ADC_22')) / 22.0
+        fudge = value(defs, 'VOLTAGE_FUDGE_FACTOR') or 0
+        ch = value(defs, 'ADMUX_VOLTAGE_DIVIDER') & 0x0f
+        mv = 1100 / 1024.0
+        common += ['-D', '%i:%f:%f' % (ch, 10 * k * mv, -fudge * k * mv)]
+    common += ['-T', str(value(defs, 'THERM_CAL_OFFSET') or 0)]
+
+    vectors = {}
+    for key in defs:
+        m = re.match(r'^(\w+_vect)_num$', key)
+        if m:
+            vectors['__vector_%i' % value(defs, key)] = m.group(1)
+
+    result = {}
+    # production build:  interrupts
+    text = simulate(elf, common, [], scenario)
+    latency = cli = 0
+    for line in text.splitlines():
+        f = line.split()
+        if f[:1] == ['isr']:
+            vect = vectors.get(f[1], f[1])
+            result['%s.avg' % vect] = int(f[4])
+            result['%s.max' % vect] = int(f[5])
+            latency = max(latency, int(f[7]))
+        elif f[:1] == ['cli']:
+            if int(f[3]) > cli:
+                cli = int(f[3])
+                result['cli.where'] = f[1]
+    result['latency.max'] = latency
+    result['cli.max'] = cli
+
+    # no-inline build:  each function
+    # (it's bigger, so it might not fit...  then there are no numbers
+    #  for the functions, and compare() calls them missing)
+    try:
+        elf = build(cfg, name, attiny, out, '-fno-inline')
+        text = simulate(elf, common, FUNCS, scenario)
+    except BenchError:
+        print('  -fno-inline build failed, so no per-function numbers')
+        text = ''
+    for line in text.splitlines():
+        f = line.split()
+        if f[:1] == ['fn'] and f[1] in FUNCS and f[2] not in ('-', '0'):
+            result['%s.avg' % f[1]] = int(f[4])
+            result['%s.max' % f[1]] = int(f[5])
+
+    for key in sorted(result):
+        print('  %-24s %s' % (key, result[key]))
+    return result
+
+
+def build(cfg, name, attiny, out, flags):
+    """Compile with bin/build.sh, and keep the .elf"""
+    build_sh(cfg, attiny, flags)
+    suffix = flags and '.noinline' or ''
+    elf = os.path.join(out, 'anduril.%s%s.elf' % (name, suffix))
+    shutil.move('anduril.elf', elf)
+    return elf
+
+
+def build_sh(cfg, attiny, flags=''):
+    """Run bin/build.sh in the current directory"""
+    # (without BUILD_DIR, so the output lands here and always gets rebuilt)
+    env = dict(os.environ)
+    env.pop('BUILD_DIR', None)
+    # only keep a ramp.h if this cfg made one
+    if os.path.exists(ramp_file()):
+        os.remove(ramp_file())
+    run([os.path.join(BIN, 'build.sh'), attiny, 'anduril',
+         '-DCONFIGFILE=%s %s' % (cfg, flags)], env=env)
+
+
+def ramp_file():
+    """Where build.sh puts the tables from a RAMP: line, if there is one"""
+    return os.path.join(os.getcwd(), 'anduril.ramp.h')
+
+
+def simulate(elf, common, funcs, scenario):
+    """Run the scenario in bench-avr, and return its report"""
+    syms = elf[:-4] + '.syms'
+    f = open(syms, 'w')
+    for line in run(['avr-nm', '-S', '--defined-only', elf]).splitlines():
+        parts = line.split()
+        # address size type name, text symbols only
+        if len(parts) == 4 and parts[2] in 'tTW':
+            f.write('%s %s %s\n' % (parts[0], parts[1], parts[3]))
+    f.close()
+    cmd = [RUNNER] + common + ['-s', syms]
+    for func in funcs:
+        cmd += ['-f', func]
+    return run(cmd + [elf, scenario])
+
+
+def macros(cfg, attiny, rampfile=None):
+    """Get every #define the firmware sees, from the preprocessor"""
+    cmd = ['avr-gcc', '-mmcu=attiny' + attiny, '-E', '-dM',
+           '-DATTINY=' + attiny, '-DCONFIGFILE=' + cfg,
+           '-I..', '-I../..', '-I../../..', 'anduril.c']
+    # (packed ramps won't preprocess without their generated tables)
+    if rampfile and os.path.exists(rampfile):
+        cmd.append('-DRAMPFILE="%s"' % rampfile)
+    dfp = os.environ.get('ATTINY_DFP')
+    if dfp:
+        cmd += ['-B', '%s/gcc/dev/attiny%s/' % (dfp, attiny),
+                '-I', '%s/include/' % dfp]
+    defs = {}
+    for line in run(cmd).splitlines():
+        m = re.match(r'^#define (\w+)(?:\s+(.*))?$', line)
+        if m:
+            defs[m.group(1)] = m.group(2) or ''
+    return defs
+
+
+def value(defs, name, depth=0):
+    """Expand a macro into a number, or None if it isn't a simple one"""
+    if name not in defs or depth > 16:
+        return None
+    text = defs[name]
+    # drop casts and integer suffixes
+    text = re.sub(r'\((?:u?int\d+_t|unsigned|int|long)\)', '', text)
+    text = re.sub(r'\b(0x[0-9a-fA-F]+|\d+)[uUlL]+\b', r'\1', text)
+    text = re.sub(r'\b0b([01]+)\b', lambda m: str(int(m.group(1), 2)), text)
+    for word in set(re.findall(r'\b[A-Za-z_]\w*\b', text)):
+        v = value(defs, word, depth + 1)
+        if v is None:
+            return None
+        text = re.sub(r'\b%s\b' % word, str(v), text)
+    try:
+        return eval(text.replace('/', '//'), {'__builtins__': {}})
+    except Exception:
+        return None
+
+
+def load_baseline(path):
+    """Read "target metric value" lines"""
+    baseline = {}
+    if not os.path.exists(path):
+        return baseline
+    for line in open(path):
+        parts = line.split()
+        if len(parts) != 3 or line.startswith('#'):
+            continue
+        target, key, val = parts
+        if val.lstrip('-').isdigit():
+            val = int(val)
+        baseline.setdefault(target, {})[key] = val
+    return baseline
+
+
+def save_baseline(path, baseline):
+    """Rewrite the baseline, keeping its header comments"""
+    header = []
+    if os.path.exists(path):
+        header = [l for l in open(path) if l.startswith('#')]
+    f = open(path, 'w')
+    f.writelines(header)
+    for target in sorted(baseline):
+        for key in sorted(baseline[target]):
+            f.write('%s %s %s\n' % (target, key, baseline[target][key]))
+    f.close()
+
+
+def compare(baseline, results, opts):
+    """Report differences, and return a list of regressions"""
+    regressions = []
+    for target in sorted(results):
+        old = baseline.get(target, {})
+        for key in sorted(results[target]):
+            new = results[target][key]
+            if not isinstance(new, int):
+                continue
+            if key not in old:
+                if opts['verbose']:
+                    print('%s %s: %i  (new)' % (target, key, new))
+                continue
+            was = old[key]
+            limit = was + max(SLACK, was * opts['tolerance'] / 100.0)
+            if new > limit:
+                regressions.append('%s %s: %i -> %i' % (target, key, was, new))
+            elif new != was or opts['verbose']:
+                print('%s %s: %i -> %i' % (target, key, was, new))
+        # a number which disappeared can't be checked any more
+        for key in sorted(old):
+            if (key not in results[target]) and isinstance(old[key], int):
+                regressions.append('%s %s: %i -> missing' % (
+                    target, key, old[key]))
+    return regressions
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
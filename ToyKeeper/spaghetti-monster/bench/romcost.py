@@ -0,0 +1,206 @@
+#!/usr/bin/env python
+
+"""What each USE_* flag costs, in flash, RAM, and eeprom, for each target.
+
+Run it from the program's directory:
+
+    ../bench/romcost.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the firmware as
+usual, then once more for each optional feature with that flag turned
+the other way:  off if the target has it, on if it doesn't.  Then it
+prints how many bytes each feature costs, and which functions the bytes
+landed in (according to the symbol table), biggest first.  Features
+which won't build the other way (too big, or missing some hardware) say
+so.  Everything also goes into romcost-out/matrix.tsv, one row per
+target and flag, for spreadsheets.
+
+Options:
+    --flag USE_FOO  only try this flag  (can be repeated)
+    --on            only try turning off flags which are on
+    --where N       how many functions to list per flag  (default 3)
+
+The flags come from config-default.h and the cfg-*.h files.  Most code
+gets inlined, because of -fwhole-program, so the bytes usually show up
+in whichever function calls the feature's code.
+
+Needs avr-gcc, avr-nm, and avr-size.
+"""
+
+from __future__ import print_function
+
+import os
+import re
+import shutil
+import sys
+
+from bench import BenchError, build_sh, macros, mcu_of, ramp_file, run, \
+    value
+
+WHERE = 3
+FLAG_FILES = ['config-default.h']  # (plus every cfg-*.h)
+
+
+def main(args):
+    """Build each target with each flag flipped, and tabulate the costs"""
+    opts = {'flags': [], 'on': False, 'where': WHERE}
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--flag':
+            opts['flags'].append(args.pop(0))
+        elif arg == '--on':
+            opts['on'] = True
+        elif arg == '--where':
+            opts['where'] = int(args.pop(0))
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+
+    out = os.path.join(os.getcwd(), 'romcost-out')
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    targets = sorted(t for t in os.listdir('.')
+                     if t.startswith('cfg-') and t.endswith('.h'))
+    flags = opts['flags'] or find_flags(FLAG_FILES + targets)
+    matrix = open(os.path.join(out, 'matrix.tsv'), 'w')
+    matrix.write('target\tflag\tstate\tflash\tram\teeprom\twhere\n')
+
+    failed = []
+    for cfg in targets:
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        attiny = mcu_of(cfg)
+        try:
+            rows, base = target_costs(cfg, name, attiny, out, flags, opts)
+        except (OSError, BenchError) as e:
+            print('===== %s =====' % name)
+            print('  %s' % str(e).splitlines()[0])
+            failed.append(name)
+            continue
+
+        print('===== %s  (attiny%s:  %i / %s flash, %i / %s ram, %i eeprom) ====='
+              % (name, attiny, base['flash'], base['flash_max'] or '?',
+                 base['ram'], base['ram_max'] or '?', base['eeprom']))
+        print('  %-34s %-5s %6s %5s %6s  %s' % (
+            'flag', 'state', 'flash', 'ram', 'eeprom', 'where'))
+        for flag, state, cost in rows:
+            if not cost:
+                print('  %-34s %-5s %s' % (flag, state, "doesn't build"))
+                matrix.write('%s\t%s\t%s\t\t\t\t\n' % (name, flag, state))
+                continue
+            where = cost['where'][:opts['where']]
+            print('  %-34s %-5s %+6i %+5i %+6i  %s' % (
+                flag, state, cost['flash'], cost['ram'], cost['eeprom'],
+                ', '.join('%s %+i' % (s, b) for s, b in where)))
+            matrix.write('%s\t%s\t%s\t%i\t%i\t%i\t%s\n' % (
+                name, flag, state, cost['flash'], cost['ram'],
+                cost['eeprom'], ' '.join('%s:%+i' % w for w in cost['where'])))
+        sys.stdout.flush()
+        matrix.flush()
+    matrix.close()
+
+    if failed:
+        print('Failed: %s' % ' '.join(failed))
+        return 1
+    return 0
+
+
+def find_flags(files):
+    """Every USE_* flag which the config files set, unset, or mention"""
+    flags = set()
+    for path in files:
+        for line in open(path):
+            m = re.match(r'^\s*(?://\s*)?#\s*(?:define|undef)\s+(USE_\w+)',
+                         line)
+            if m:
+                flags.add(m.group(1))
+    return sorted(flags)
+
+
+def target_costs(cfg, name, attiny, out, flags, opts):
+    """Build one target every way, and return [(flag, state, cost)]"""
+    base = measure(build(cfg, name, attiny, out))
+    defs = macros(cfg, attiny, ramp_file())
+    base['flash_max'] = (value(defs, 'FLASHEND') or -1) + 1
+    base['ram_max'] = None
+    if value(defs, 'RAMEND') is not None and value(defs, 'RAMSTART') is not None:
+        base['ram_max'] = value(defs, 'RAMEND') - value(defs, 'RAMSTART') + 1
+
+    rows = []
+    for flag in flags:
+        on = flag in defs
+        if opts['on'] and not on:
+            continue
+        # a cfg which wraps the real one, and flips the flag
+        wrapper = os.path.join(out, cfg)
+        f = open(wrapper, 'w')
+        for line in open(cfg):
+            if 'ATTINY:' in line:
+                f.write(line)
+        f.write('#include "../%s"\n' % cfg)
+        if on:
+            f.write('#undef %s\n' % flag)
+        else:
+            f.write('#define %s\n' % flag)
+        f.close()
+        try:
+            other = measure(build(os.path.relpath(wrapper), name, attiny, out))
+        except BenchError:
+            rows.append((flag, on and 'on' or 'off', None))
+            continue
+        # (cost is always with the flag minus without it)
+        have, lack = on and (base, other) or (other, base)
+        cost = dict((k, have[k] - lack[k]) for k in ('flash', 'ram', 'eeprom'))
+        cost['where'] = where(have['symbols'], lack['symbols'])
+        rows.append((flag, on and 'on' or 'off', cost))
+    rows.sort(key=lambda r: -(r[2] and abs(r[2]['flash']) or 0))
+    return rows, base
+
+
+def build(cfg, name, attiny, out):
+    """Compile with bin/build.sh, and keep the .elf"""
+    build_sh(cfg, attiny)
+    elf = os.path.join(out, 'anduril.%s.elf' % name)
+    shutil.move('anduril.elf', elf)
+    return elf
+
+
+def measure(elf):
+    """Flash, RAM, and eeprom bytes, plus every symbol's size"""
+    sizes = {}
+    for line in run(['avr-size', '-A', elf]).splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[1].isdigit():
+            sizes[parts[0]] = int(parts[1])
+    symbols = {}
+    for line in run(['avr-nm', '-S', elf]).splitlines():
+        parts = line.split()
+        # address size type name
+        if len(parts) == 4 and parts[2] in 'tTWdDbB':
+            symbols[parts[3]] = int(parts[1], 16)
+    data = sizes.get('.data', 0)
+    return {'flash': sizes.get('.text', 0) + data,
+            'ram': data + sizes.get('.bss', 0) + sizes.get('.noinit', 0),
+            # FSM keeps a copy of its eeprom in RAM, the same size
+            'eeprom': symbols.get('eeprom', 0) + symbols.get('eeprom_wl', 0),
+            'symbols': symbols}
+
+
+def where(have, lack):
+    """Which symbols changed size:  [(name, bytes), ...], biggest first"""
+    changes = []
+    for s in set(have) | set(lack):
+        d = have.get(s, 0) - lack.get(s, 0)
+        if d:
+            changes.append((s, d))
+    changes.sort(key=lambda c: (-abs(c[1]), c[0]))
+    return changes
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
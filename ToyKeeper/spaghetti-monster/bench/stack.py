@@ -0,0 +1,414 @@
+#!/usr/bin/env python
+
+"""Worst-case stack depth and RAM budget for each build target.
+
+Run it from the program's directory:
+
+    ../bench/stack.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the firmware with
+-fstack-usage, takes each function's frame size from the .su file, and
+follows the calls in the disassembly to find the deepest chain from
+main() ...  plus the deepest interrupt handler on top of that, since an
+interrupt can arrive at the worst possible moment.  Static RAM (.data,
+.bss, and .noinit) plus that peak has to fit in the MCU's RAM with
+--margin bytes to spare, or the target fails.
+
+Options:
+    --margin N      bytes which must stay free  (default 32)
+    --handlers N    how many state handlers can run inside each other
+                    (default 3)
+    -v              show the deepest call chains, and the biggest variables
+
+Some of it is guesswork:
+  - Indirect calls (like emit_now() calling a state) can go to any
+    function whose address gets loaded with a pair of ldi's, or any
+    function named *_state.
+  - FSM code recurses:  nice_delay_ms() handles events, so a handler
+    which blinks can have another handler running inside it, and
+    set_state() runs the new state's handler too.  Indirect calls get
+    followed until --handlers of them are nested.
+  - Functions with no .su entry (libgcc, avr-libc) get an estimate from
+    how many registers they push.
+  - Tail calls count like normal calls, which overestimates a little.
+  - Interrupts don't nest, unless a handler turns them back on.
+
+Needs avr-gcc, avr-objdump, avr-nm, and avr-size.
+"""
+
+from __future__ import print_function
+
+import os
+import re
+import shutil
+import sys
+
+from bench import BenchError, build_sh, macros, mcu_of, ramp_file, run, \
+    value
+
+MARGIN = 32  # bytes
+HANDLERS = 3
+OBJDUMP = 'avr-objdump'
+INDIRECT = re.compile(r'_state$')  # FSM states get called through pointers
+RAM_SECTIONS = ('.data', '.bss', '.noinit')
+
+
+def main(args):
+    """Build and analyze each target"""
+    opts = {'margin': MARGIN, 'handlers': HANDLERS, 'verbose': False}
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--margin':
+            opts['margin'] = int(args.pop(0))
+        elif arg == '--handlers':
+            opts['handlers'] = int(args.pop(0))
+        elif arg == '-v':
+            opts['verbose'] = True
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+
+    out = os.path.join(os.getcwd(), 'stack-out')
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    print('%-28s %5s %5s %6s %5s %5s %5s %5s' % (
+        'target', 'mcu', 'ram', 'static', 'main', 'isr', 'peak', 'free'))
+    tight = []
+    failed = []
+    targets = sorted(t for t in os.listdir('.')
+                     if t.startswith('cfg-') and t.endswith('.h'))
+    for cfg in targets:
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        attiny = mcu_of(cfg)
+        try:
+            r = analyze(cfg, name, attiny, out, opts)
+        except (OSError, BenchError) as e:
+            print('%-28s %5s %s' % (name, attiny, str(e).splitlines()[0]))
+            failed.append(name)
+            continue
+        free = r['ram'] - r['static'] - r['peak']
+        flag = ''
+        if free < opts['margin']:
+            flag = '  <-- too tight'
+            tight.append(name)
+        print('%-28s %5s %5i %6i %5i %5i %5i %5i%s' % (
+            name, attiny, r['ram'], r['static'], r['main'][0],
+            r['isr'][0], r['peak'], free, flag))
+        if opts['verbose']:
+            describe(r)
+        sys.stdout.flush()
+
+    if failed:
+        print('Failed: %s' % ' '.join(failed))
+    if tight:
+        print('Less than %i bytes free: %s' % (opts['margin'], ' '.join(tight)))
+    if failed or tight:
+        return 1
+    return 0
+
+
+def analyze(cfg, name, attiny, out, opts):
+    """Build one target, and return its RAM and stack numbers"""
+    build_sh(cfg, attiny, '-fstack-usage')
+    defs = macros(cfg, attiny, ramp_file())
+    ramend = value(defs, 'RAMEND')
+    ramstart = value(defs, 'RAMSTART')
+    if ramend is None or ramstart is None:
+        raise BenchError("can't find RAMSTART / RAMEND")
+
+    elf = os.path.join(out, 'anduril.%s.elf' % name)
+    su = os.path.join(out, 'anduril.%s.su' % name)
+    shutil.move('anduril.elf', elf)
+    shutil.move('anduril.su', su)
+
+    vectors = {}
+    for key in defs:
+        m = re.match(r'^(\w+_vect)_num$', key)
+        if m:
+            vectors['__vector_%i' % value(defs, key)] = m.group(1)
+
+    # (parts with more than 128K of flash push 3-byte return addresses)
+    ret = 2
+    if (value(defs, 'FLASHEND') or 0) > 0x1ffff:
+        ret = 3
+
+    funcs = disassemble(elf)
+    frames, notes = frame_sizes(funcs, parse_su(su), ret)
+    graph, pointers = call_graph(funcs)
+    looped = cycles_through(graph)
+    if looped:
+        notes.append('recursion (counted once): %s' % ' '.join(sorted(looped)))
+
+    r = {'ram': ramend - ramstart + 1, 'static': static_ram(elf),
+         'notes': notes, 'vectors': vectors, 'frames': frames,
+         'biggest': biggest(elf)}
+
+    def depth(root):
+        return deepest(funcs, graph, pointers, frames, looped, root,
+                       opts['handlers'])
+    r['main'] = depth('main')
+
+    # interrupts go on top of whatever main() was doing
+    isrs = []
+    for f in sorted(graph):
+        if re.match(r'^__vector_\d+$', f):
+            reaches = reachable(funcs, graph, pointers, f)
+            isrs.append((depth(f), any(funcs[g]['sei'] for g in reaches)))
+    nested = [d for d, nests in isrs if nests]
+    others = [d for d, nests in isrs if not nests]
+    worst = max(others or [(0, [])])
+    r['isr'] = (sum(d[0] for d in nested) + worst[0],
+                worst[1], [d[1] for d in nested])
+    r['peak'] = r['main'][0] + r['isr'][0]
+    return r
+
+
+def describe(r):
+    """Show where the numbers came from"""
+    def chain(funcs):
+        return ' > '.join('%s(%i)' % (r['vectors'].get(f, f), r['frames'][f])
+                          for f in funcs)
+    print('    main: %s' % chain(r['main'][1]))
+    if r['isr'][1]:
+        print('    isr:  %s' % chain(r['isr'][1]))
+    for funcs in r['isr'][2]:
+        print('    isr (nests):  %s' % chain(funcs))
+    for note in r['notes']:
+        print('    %s' % note)
+    print('    biggest variables: %s' % ', '.join(
+        '%s(%i)' % (n, s) for s, n in r['biggest']))
+
+
+def disassemble(elf):
+    """Read the code into {function: what it does}"""
+    funcs = {}
+    f = None
+    regs = {}
+    for line in run([OBJDUMP, '-d', elf]).splitlines():
+        m = re.match(r'^([0-9a-f]+) <([^>]+)>:$', line)
+        if m:
+            f = {'addr': int(m.group(1), 16), 'calls': set(),
+                 'indirect': False, 'sei': False, 'pushes': 0,
+                 'refs': set(), 'names': set()}
+            funcs[m.group(2)] = f
+            regs = {}
+            continue
+        parts = line.split('\t')
+        if f is None or len(parts) < 3 or not parts[0].strip().endswith(':'):
+            continue
+        insn = '\t'.join(parts[2:]).split(None, 1)
+        op = insn[0]
+        args = len(insn) > 1 and insn[1] or ''
+        m = re.search(r'<([^>+]+)>\s*$', args)
+        target = m and m.group(1)
+        if op in ('call', 'rcall', 'callq'):
+            if '*' in args:  # (x86 hosts, for testing)
+                f['indirect'] = True
+            elif target:
+                f['calls'].add(target)
+        elif op in ('jmp', 'rjmp', 'jmpq'):
+            # a tail call, unless it's a loop back to the top
+            if target and funcs.get(target) is not f:
+                f['calls'].add(target)
+        elif op in ('icall', 'eicall'):
+            f['indirect'] = True
+        elif op == 'sei':
+            f['sei'] = True
+        elif op == 'push':
+            f['pushes'] += 1
+        elif op == 'ldi':
+            # function pointers get loaded as word addresses, a byte at
+            # a time, into a register pair
+            m = re.match(r'r(\d+),\s*0x([0-9a-fA-F]+)', args)
+            if m:
+                reg = int(m.group(1))
+                regs[reg] = int(m.group(2), 16)
+                lo, hi = reg & ~1, reg | 1
+                if lo in regs and hi in regs:
+                    f['refs'].add((regs[lo] | (regs[hi] << 8)) * 2)
+        elif target and not op.startswith('br'):
+            f['names'].add(target)
+    return funcs
+
+
+def parse_su(path):
+    """Read frame sizes from a .su file:  {function: (bytes, type)}"""
+    sizes = {}
+    for line in open(path):
+        parts = line.rstrip('\n').split('\t')
+        if len(parts) != 3:
+            continue
+        name = parts[0].rsplit(':', 1)[-1]
+        size = int(parts[1])
+        # (clones of one function share a name, so take the biggest)
+        if name not in sizes or size > sizes[name][0]:
+            sizes[name] = (size, parts[2])
+    return sizes
+
+
+def frame_sizes(funcs, su, ret=2):
+    """Bytes of stack for each function, including its return address
+
+    (the .su sizes don't count the return address, so it gets added to
+     those too, not only to the guesses)
+    """
+    frames = {}
+    notes = []
+    guessed = []
+    for name in sorted(funcs):
+        base = name.split('.')[0]  # foo.constprop.0 -> foo
+        if base in su:
+            size, kind = su[base]
+            size += ret
+            if kind != 'static':
+                notes.append('%s has a %s frame, at least %i bytes' % (
+                    name, kind, size))
+        else:
+            size = funcs[name]['pushes'] + ret
+            guessed.append(name)
+        frames[name] = size
+    if guessed:
+        notes.append('guessed: %s' % ' '.join(guessed))
+    return frames, notes
+
+
+def call_graph(funcs):
+    """{function: functions it calls}, and what indirect calls can reach"""
+    by_addr = dict((f['addr'], name) for name, f in funcs.items())
+    # anything whose address the code uses could get called indirectly
+    pointers = set(name for name in funcs if INDIRECT.search(name))
+    for f in funcs.values():
+        pointers |= set(by_addr[a] for a in f['refs'] if a in by_addr)
+        pointers |= set(n for n in f['names'] if n in funcs)
+    graph = {}
+    for name, f in funcs.items():
+        graph[name] = set(c for c in f['calls'] if c in funcs)
+    return graph, pointers
+
+
+def reachable(funcs, graph, pointers, root):
+    """Every function which root might end up calling, and root"""
+    seen = set([root])
+    todo = [root]
+    while todo:
+        f = todo.pop()
+        calls = graph[f]
+        if funcs[f]['indirect']:
+            calls = calls | pointers
+        for g in calls:
+            if g not in seen:
+                seen.add(g)
+                todo.append(g)
+    return seen
+
+
+def cycles_through(graph):
+    """Functions which can end up calling themselves, directly"""
+    # Tarjan's algorithm, without recursion since the graph can be deep
+    index = {}
+    low = {}
+    stack = []
+    on_stack = set()
+    looped = set()
+    counter = [0]
+    for root in graph:
+        if root in index:
+            continue
+        work = [(root, iter(sorted(graph[root])))]
+        index[root] = low[root] = counter[0]
+        counter[0] += 1
+        stack.append(root)
+        on_stack.add(root)
+        while work:
+            f, children = work[-1]
+            for g in children:
+                if g not in index:
+                    index[g] = low[g] = counter[0]
+                    counter[0] += 1
+                    stack.append(g)
+                    on_stack.add(g)
+                    work.append((g, iter(sorted(graph[g]))))
+                    break
+                elif g in on_stack:
+                    low[f] = min(low[f], index[g])
+            else:
+                work.pop()
+                if work:
+                    low[work[-1][0]] = min(low[work[-1][0]], low[f])
+                if low[f] == index[f]:
+                    scc = []
+                    while True:
+                        g = stack.pop()
+                        on_stack.discard(g)
+                        scc.append(g)
+                        if g == f:
+                            break
+                    if len(scc) > 1 or f in graph[f]:
+                        looped.update(scc)
+    return looped
+
+
+def deepest(funcs, graph, pointers, frames, looped, root, handlers):
+    """The most stack root can use:  (bytes, call chain)"""
+    if root not in graph:
+        return (0, [])
+    memo = {}
+    running = set()
+
+    # (each indirect call uses up one of the handlers, so the same
+    #  function can show up again deeper in the chain, but only after
+    #  another handler got called)
+    def walk(f, left):
+        if (f, left) in memo:
+            return memo[(f, left)]
+        running.add((f, left))
+        calls = [(g, left) for g in graph[f]]
+        if funcs[f]['indirect'] and left:
+            calls += [(g, left - 1) for g in pointers]
+        best = (0, [])
+        for g, n in sorted(calls):
+            if (g, n) in running:
+                continue  # (plain recursion only gets counted once)
+            d = walk(g, n)
+            if d[0] > best[0]:
+                best = d
+        running.discard((f, left))
+        result = (frames[f] + best[0], [f] + best[1])
+        # (inside a loop, it depends on how it got there)
+        if f not in looped:
+            memo[(f, left)] = result
+        return result
+
+    sys.setrecursionlimit(max(sys.getrecursionlimit(), 10000))
+    return walk(root, handlers)
+
+
+def static_ram(elf):
+    """Bytes of RAM used by variables"""
+    total = 0
+    for line in run(['avr-size', '-A', elf]).splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[0] in RAM_SECTIONS:
+            total += int(parts[1])
+    return total
+
+
+def biggest(elf, count=5):
+    """The variables which take the most RAM:  [(bytes, name), ...]"""
+    found = []
+    for line in run(['avr-nm', '-S', '--size-sort', elf]).splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in 'bBdD':
+            found.append((int(parts[1], 16), parts[3]))
+    found.sort(reverse=True)
+    return found[:count]
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -210,7 +210,7 @@ ISR(ADC_vect) {
         *v = s;
 
         // track what woke us up, and enable deferred logic
-        irq_adc = 1;
+        task_post(TASK_ADC);
 
     }
 
@@ -222,8 +222,6 @@ ISR(ADC_vect) {
 }
 
 void adc_deferred() {
-    irq_adc = 0;  // event handled
-
     #ifdef USE_PSEUDO_RAND
     // real-world entropy makes this a true random, not pseudo
     // Why here instead of the ISR?  Because it makes the time-critical ISR
@@ -555,6 +553,31 @@ void battcheck() {
     #endif
     #endif
 }
+
+#ifdef USE_COROUTINES
+// same as battcheck(), but as a coroutine
+uint8_t co_battcheck(Coroutine *co) {
+    static Coroutine blink_co;
+    #ifndef BATTCHECK_VpT
+    static uint8_t i;
+    #endif
+    CO_BEGIN(co);
+
+    #ifdef BATTCHECK_VpT
+    CO_CALL(co, &blink_co, co_blink_num(&blink_co, voltage));
+    #else
+    for(i=0;
+        voltage >= pgm_read_byte(voltage_blinks + i);
+        i++) {}
+    CO_CALL(co, &blink_co, co_blink_digit(&blink_co, i));
+    #ifndef DONT_DELAY_AFTER_BATTCHECK
+    CO_SLEEP_MS(co, 1000);
+    #endif
+    #endif
+
+    CO_END(co);
+}
+#endif
 #endif
 
 #endif
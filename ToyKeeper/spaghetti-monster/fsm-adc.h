@@ -45,7 +45,6 @@ volatile uint8_t adc_reset = 2;
 #endif
 #endif
 
-volatile uint8_t irq_adc = 0;  // ADC interrupt happened?
 uint8_t adc_sample_count = 0;  // skip the first sample; it's junk
 uint8_t adc_channel = 0;  // 0=voltage, 1=temperature
 uint16_t adc_raw[2];  // last ADC measurements (0=voltage, 1=temperature)
@@ -69,6 +68,9 @@ void low_voltage();
 
 #ifdef USE_BATTCHECK
 void battcheck();
+#ifdef USE_COROUTINES
+uint8_t co_battcheck(Coroutine *co);
+#endif
 #ifdef BATTCHECK_VpT
 #define USE_BLINK_NUM
 #endif
@@ -0,0 +1,52 @@
+/*
+ * fsm-coroutine.c: Coroutine (protothread) functions for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_COROUTINE_C
+#define FSM_COROUTINE_C
+
+#ifdef USE_COROUTINES
+
+uint8_t co_delay(Coroutine *co) {
+    if (! co->wait) return CO_DONE;
+    delay_one_ms();
+    co->wait --;
+    return CO_BUSY;
+}
+
+void co_sleep_start(Coroutine *co, uint16_t ms) {
+    // 16ms per tick, rounded
+    co->wait = (ms + 8) >> 4;
+    co->tick = co_ticks;
+}
+
+uint8_t co_sleep(Coroutine *co) {
+    uint8_t now = co_ticks;
+    uint8_t elapsed = now - co->tick;
+    co->tick = now;
+    if (co->wait > elapsed) {
+        co->wait -= elapsed;
+        return CO_IDLE;
+    }
+    co->wait = 0;
+    return CO_DONE;
+}
+
+#endif  // ifdef USE_COROUTINES
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * fsm-coroutine.h: Coroutine (protothread) functions for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_COROUTINE_H
+#define FSM_COROUTINE_H
+
+#ifdef USE_COROUTINES
+
+// Stackless coroutines, a.k.a. protothreads, for animations in loop().
+// Instead of blocking inside nice_delay_ms(), a coroutine returns to the
+// main loop while it waits, and picks up where it left off next time.
+//
+// Caveats:
+//   - Local variables don't survive a yield or delay.  Use static.
+//   - Only one CO_* wait per line of code.  (they use __LINE__)
+//   - Don't use switch() around a CO_* wait.
+
+typedef struct Coroutine {
+    uint16_t line;  // where to resume  (0 = start from the top)
+    uint16_t wait;  // ms or ticks left in the current delay
+    uint8_t tick;   // co_ticks at the last check
+} Coroutine;
+
+// coroutine return values
+#define CO_DONE 0  // finished  (the next call starts over)
+#define CO_BUSY 1  // call again soon  (timing matters)
+#define CO_IDLE 2  // call again after the next interrupt  (MCU can idle)
+
+// for the recipe's loop() animations
+// (restarts automatically on state change or completed input,
+//  like nice_delay_ms() aborting)
+Coroutine loop_co;
+
+// counts clock ticks, for CO_SLEEP_MS()
+uint8_t co_ticks = 0;
+
+#define CO_BEGIN(co)  switch ((co)->line) { case 0:
+#define CO_END(co)    } (co)->line = 0; return CO_DONE
+#define CO_RESET(co)  ((co)->line = 0)
+
+// go back to the main loop, and resume here next time
+#define CO_YIELD(co)  do { (co)->line = __LINE__; return CO_BUSY; \
+                           case __LINE__: ; } while (0)
+
+// resume here until func(co) returns CO_DONE
+#define CO_WAIT(co, func)  do { (co)->line = __LINE__; case __LINE__: \
+                                { uint8_t co_r = func(co); \
+                                  if (co_r) return co_r; } } while (0)
+
+// run another coroutine until it's done
+// (child is its context, call is the function call which uses it)
+#define CO_CALL(co, child, call)  do { CO_RESET(child); \
+                                       (co)->line = __LINE__; case __LINE__: \
+                                       { uint8_t co_r = (call); \
+                                         if (co_r) return co_r; } } while (0)
+
+// precise delay, for short blinks and strobes
+// (waits 1ms per call, so the MCU stays awake)
+#define CO_DELAY_MS(co, ms)  do { (co)->wait = (ms); \
+                                  CO_WAIT(co, co_delay); } while (0)
+
+// sloppy delay, for long pauses
+// (counted in clock ticks, so it's only accurate to ~16ms, but the MCU
+//  can idle the whole time)
+#define CO_SLEEP_MS(co, ms)  do { co_sleep_start(co, ms); \
+                                  CO_WAIT(co, co_sleep); } while (0)
+
+uint8_t co_delay(Coroutine *co);
+void co_sleep_start(Coroutine *co, uint16_t ms);
+uint8_t co_sleep(Coroutine *co);
+
+#endif  // ifdef USE_COROUTINES
+
+#endif
@@ -24,44 +24,78 @@
 
 
 void append_emission(Event event, uint16_t arg) {
-    uint8_t i;
-    // find last entry
-    for(i=0;
-        (i<EMISSION_QUEUE_LEN) && (emissions[i].event != EV_none);
-        i++) { }
-    // add new entry
-    if (i < EMISSION_QUEUE_LEN) {
-        emissions[i].event = event;
-        emissions[i].arg = arg;
-    } else {
-        // TODO: if queue full, what should we do?
+    uint8_t tail = emissions_tail;
+
+    // if the newest entry is a tick which hasn't been handled yet,
+    // merge this tick into it instead of adding another one
+    // (so a burst of ticks while the UI is busy can't fill the queue
+    //  and push out real button events)
+    if ((event == EV_tick) && (tail != emissions_head)) {
+        Emission *prev = emissions + ((uint8_t)(tail - 1) & EMISSION_QUEUE_MASK);
+        if (prev->event == EV_tick) {
+            prev->arg = arg;
+            if (prev->ticks < 255) prev->ticks ++;
+            return;
+        }
     }
-}
 
-void delete_first_emission() {
-    uint8_t i;
-    for(i=0; i<EMISSION_QUEUE_LEN-1; i++) {
-        emissions[i].event = emissions[i+1].event;
-        emissions[i].arg = emissions[i+1].arg;
+    // queue full?
+    if ((uint8_t)(tail - emissions_head) >= EMISSION_QUEUE_LEN) {
+        if (emission_overflows < 255) emission_overflows ++;
+        // ticks are redundant; the next one will carry an updated arg
+        // so just drop this one and keep whatever is already waiting
+        if (event == EV_tick) return;
+        // anything else is probably user input, which matters more than
+        // stale events...  so make room by dropping the oldest entry
+        emissions_head ++;
     }
-    emissions[i].event = EV_none;
-    emissions[i].arg = 0;
+
+    // add new entry
+    Emission *e = emissions + (tail & EMISSION_QUEUE_MASK);
+    e->event = event;
+    e->ticks = 1;
+    e->arg = arg;
+    emissions_tail = tail + 1;
+}
+
+// remove the oldest entry from the queue
+// return value:
+//   0: queue was already empty
+//   1: an entry was removed
+uint8_t delete_first_emission() {
+    uint8_t head = emissions_head;
+    if (head == emissions_tail) return 0;
+    emissions_head = head + 1;
+    return 1;
 }
 
 void process_emissions() {
-    while (emissions[0].event != EV_none) {
-        emit_now(emissions[0].event, emissions[0].arg);
-        delete_first_emission();
+    uint8_t head;
+    while ((head = emissions_head) != emissions_tail) {
+        // remove the event from the queue *before* sending it,
+        // because the handler might call nice_delay_ms(), which calls
+        // process_emissions() again...  and the nested call shouldn't
+        // see (and re-send) the event which is already being handled
+        Emission *e = emissions + (head & EMISSION_QUEUE_MASK);
+        Event event = e->event;
+        uint16_t arg = e->arg;
+        if (event == EV_tick) tick_delta = e->ticks;
+        emissions_head = head + 1;
+        emit_now(event, arg);
     }
 }
 
 // Call stacked callbacks for the given event until one handles it.
 uint8_t emit_now(Event event, uint16_t arg) {
-    for(int8_t i=state_stack_len-1; i>=0; i--) {
+    int8_t i;
+    for(i=state_stack_len-1; i>=0; i--) {
         uint8_t err = state_stack[i](event, arg);
-        if (! err) return 0;
+        if (! err) break;
     }
-    return 1;  // event not handled
+    #ifdef USE_EVENT_TRACE
+    trace_event(event, arg, i);
+    #endif
+    return (i < 0);  // 1 = event not handled
 }
 
 void emit(Event event, uint16_t arg) {
@@ -116,11 +150,77 @@ uint8_t push_event(uint8_t ev_type) {  // only for use by PCINT_inner()
     return 0;  // unexpected event type
 }
 
+#ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+// add one gap to the histogram, and adjust the release timeout to fit
+void learn_click_gap(uint16_t gap) {
+    // a gap this long would have been two separate inputs anyway
+    if (gap >= RELEASE_TIMEOUT_CEIL) return;
+
+    uint8_t *bin = click_gaps + (gap / CLICK_GAP_BIN_WIDTH);
+    // forget old data gradually, by halving everything when a bin fills up
+    if (*bin == 255) {
+        for (uint8_t i=0; i<CLICK_GAP_BINS; i++) click_gaps[i] >>= 1;
+    }
+    (*bin) ++;
+
+    uint16_t total = 0;
+    for (uint8_t i=0; i<CLICK_GAP_BINS; i++) total += click_gaps[i];
+    // not enough data yet?  keep the old value
+    if (total < 16) return;
+
+    // find the bin which covers ~15/16 of recent gaps
+    uint16_t count = 0;
+    uint8_t i;
+    for (i=0; i<CLICK_GAP_BINS-1; i++) {
+        count += click_gaps[i];
+        if (count >= (total - (total>>4))) break;
+    }
+    // wait until the end of that bin, plus a safety margin
+    uint8_t timeout = ((i+1) * CLICK_GAP_BIN_WIDTH) + RELEASE_TIMEOUT_MARGIN;
+    if (timeout < RELEASE_TIMEOUT_FLOOR) timeout = RELEASE_TIMEOUT_FLOOR;
+    if (timeout > RELEASE_TIMEOUT_CEIL) timeout = RELEASE_TIMEOUT_CEIL;
+    release_timeout = timeout;
+}
+#endif
 
 // explicitly interrupt these "nice" delays
 volatile uint8_t nice_delay_interrupt = 0;
 inline void interrupt_nice_delays() { nice_delay_interrupt = 1; }
 
+// wait about 1ms, while using as little power as possible
+// (the extra ~10% is left for whatever the caller does between waits)
+inline void delay_one_ms() {
+    #ifdef USE_DYNAMIC_UNDERCLOCKING
+    #ifdef USE_RAMPING
+    uint8_t level = actual_level;  // volatile, avoid repeat access
+    if (level < QUARTERSPEED_LEVEL) {
+        clock_prescale_set(clock_div_4);
+        _delay_loop_2(BOGOMIPS*90/100/4);
+    }
+    //else if (level < HALFSPEED_LEVEL) {
+    //    clock_prescale_set(clock_div_2);
+    //    _delay_loop_2(BOGOMIPS*95/100/2);
+    //}
+    else {
+        clock_prescale_set(clock_div_1);
+        _delay_loop_2(BOGOMIPS*90/100);
+    }
+    // restore regular clock speed
+    clock_prescale_set(clock_div_1);
+    #else
+    // underclock MCU to save power
+    clock_prescale_set(clock_div_4);
+    // wait
+    _delay_loop_2(BOGOMIPS*90/100/4);
+    // restore regular clock speed
+    clock_prescale_set(clock_div_1);
+    #endif  // ifdef USE_RAMPING
+    #else
+    // wait
+    _delay_loop_2(BOGOMIPS*90/100);
+    #endif  // ifdef USE_DYNAMIC_UNDERCLOCKING
+}
+
 // like delay_ms, except it aborts on state change
 // return value:
 //   0: state changed
@@ -138,38 +238,10 @@ uint8_t nice_delay_ms(uint16_t ms) {
             return 0;
         }
 
-        #ifdef USE_DYNAMIC_UNDERCLOCKING
-        #ifdef USE_RAMPING
-        uint8_t level = actual_level;  // volatile, avoid repeat access
-        if (level < QUARTERSPEED_LEVEL) {
-            clock_prescale_set(clock_div_4);
-            _delay_loop_2(BOGOMIPS*90/100/4);
-        }
-        //else if (level < HALFSPEED_LEVEL) {
-        //    clock_prescale_set(clock_div_2);
-        //    _delay_loop_2(BOGOMIPS*95/100/2);
-        //}
-        else {
-            clock_prescale_set(clock_div_1);
-            _delay_loop_2(BOGOMIPS*90/100);
-        }
-        // restore regular clock speed
-        clock_prescale_set(clock_div_1);
-        #else
-        // underclock MCU to save power
-        clock_prescale_set(clock_div_4);
-        // wait
-        _delay_loop_2(BOGOMIPS*90/100/4);
-        // restore regular clock speed
-        clock_prescale_set(clock_div_1);
-        #endif  // ifdef USE_RAMPING
-        #else
-        // wait
-        _delay_loop_2(BOGOMIPS*90/100);
-        #endif  // ifdef USE_DYNAMIC_UNDERCLOCKING
+        delay_one_ms();
 
         // run pending system processes while we wait
-        handle_deferred_interrupts();
+        run_tasks();
 
         // handle events only afterward, so that any collapsed delays will
         // finish running the UI's loop() code before taking any further actions
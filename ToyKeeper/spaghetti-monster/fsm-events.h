@@ -31,6 +31,33 @@
 #define RELEASE_TIMEOUT 18
 #endif
 
+#ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+// learn how fast the user actually multi-clicks, and don't wait
+// much longer than that before deciding a click sequence is done
+#ifndef RELEASE_TIMEOUT_FLOOR
+#define RELEASE_TIMEOUT_FLOOR 10  // never faster than this
+#endif
+#ifndef RELEASE_TIMEOUT_CEIL
+#define RELEASE_TIMEOUT_CEIL RELEASE_TIMEOUT  // never slower than this
+#endif
+#ifndef RELEASE_TIMEOUT_MARGIN
+#define RELEASE_TIMEOUT_MARGIN 4  // wait this much longer than a typical gap
+#endif
+// histogram of recent gaps between clicks (release to next press)
+#define CLICK_GAP_BINS 8
+#define CLICK_GAP_BIN_WIDTH ((RELEASE_TIMEOUT_CEIL + CLICK_GAP_BINS - 1) / CLICK_GAP_BINS)
+uint8_t click_gaps[CLICK_GAP_BINS];
+// current timeout, in ticks  (recipe can load/save this in eeprom)
+uint8_t release_timeout = RELEASE_TIMEOUT_CEIL;
+// did the last input end with a click release?  (so the next press
+// completes a click gap)
+uint8_t click_gap_open = 0;
+void learn_click_gap(uint16_t gap);
+#define RELEASE_TIMEOUT_NOW release_timeout
+#else
+#define RELEASE_TIMEOUT_NOW RELEASE_TIMEOUT
+#endif
+
 // return codes for Event handlers
 // Indicates whether this handler consumed (handled) the Event, or
 // if the Event should be sent to the next handler in the stack.
@@ -43,6 +70,7 @@
 typedef uint8_t Event;
 typedef struct Emission {
     Event event;
+    uint8_t ticks;  // EV_tick only: how many clock ticks this entry covers
     uint16_t arg;
 } Emission;
 
@@ -52,14 +80,35 @@ static volatile uint16_t ticks_since_last_event = 0;
 
 // maximum number of events which can be waiting at one time
 // (would probably be okay to reduce this to 4, but it's higher to be safe)
+// (must be a power of 2, because the queue is a ring buffer which wraps
+//  around using a bitmask instead of shifting entries down every time)
+#ifndef EMISSION_QUEUE_LEN
 #define EMISSION_QUEUE_LEN 16
+#endif
+#if (EMISSION_QUEUE_LEN & (EMISSION_QUEUE_LEN-1)) || (EMISSION_QUEUE_LEN > 128)
+#error EMISSION_QUEUE_LEN must be a power of 2, no larger than 128
+#endif
+#define EMISSION_QUEUE_MASK (EMISSION_QUEUE_LEN-1)
 // was "volatile" before, changed to regular var since IRQ rewrites seem
 // to have removed the need for it to be volatile
 // no comment about "volatile emissions"
 Emission emissions[EMISSION_QUEUE_LEN];
+// ring buffer positions, which count up forever and wrap at 256
+// (only the low bits are used as an index, so tail - head = queue length)
+// head: next event to process
+// tail: next free slot
+uint8_t emissions_head = 0;
+uint8_t emissions_tail = 0;
+// while handling EV_tick, how many clock ticks have passed since the
+// previous EV_tick  (usually 1, but consecutive ticks are merged into one
+// queue entry if the UI is too busy to handle them right away)
+uint8_t tick_delta = 1;
+// how many times the queue was full when something tried to add an event
+// (counts up to 255 and stays there, so it can be checked for debugging)
+uint8_t emission_overflows = 0;
 
 void append_emission(Event event, uint16_t arg);
-void delete_first_emission();
+uint8_t delete_first_emission();
 void process_emissions();
 uint8_t emit_now(Event event, uint16_t arg);
 void emit(Event event, uint16_t arg);
@@ -71,6 +120,7 @@ uint8_t push_event(uint8_t ev_type);  // only for use by PCINT_inner()
 // TODO: Maybe move these to their own file...
 // ... this probably isn't the right place for delays.
 inline void interrupt_nice_delays();
+inline void delay_one_ms();
 uint8_t nice_delay_ms(uint16_t ms);
 //uint8_t nice_delay_s();
 void delay_4ms(uint8_t ms);
@@ -109,6 +159,9 @@ void delay_4ms(uint8_t ms);
 #ifdef TICK_DURING_STANDBY
 #define EV_sleep_tick          (B_SYSTEM|0b00000011)
 #endif
+#ifdef USE_TIMERS
+#define EV_timer               (B_SYSTEM|0b00000010)
+#endif
 #ifdef USE_LVP
 #define EV_voltage_low         (B_SYSTEM|0b00000100)
 #endif
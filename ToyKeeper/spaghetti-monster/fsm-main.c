@@ -112,12 +112,21 @@ int main() {
     // Don't allow interrupts while booting
     cli();
 
+    #ifdef USE_EVENT_TRACE
+    uint8_t reset_flags = TRACE_RESET_FLAGS;
+    #endif
+
     //#ifdef USE_REBOOT
     // prevents cycling after a crash,
     // whether intentional (like factory reset) or not (bugs)
     prevent_reboot_loop();
     //#endif
 
+    #ifdef USE_EVENT_TRACE
+    // save what happened before the crash, if there was one
+    trace_boot(reset_flags);
+    #endif
+
     hw_setup();
 
     #if 0
@@ -191,7 +200,12 @@ int main() {
         }
 
         // catch up on interrupts
-        handle_deferred_interrupts();
+        run_tasks();
+
+        #ifdef USE_COROUTINES
+        // state changed or input finished?  restart loop() animations
+        if (nice_delay_interrupt) CO_RESET(&loop_co);
+        #endif
 
         // turn delays back on, if they were off
         nice_delay_interrupt = 0;
@@ -203,21 +217,4 @@ int main() {
 }
 
 
-void handle_deferred_interrupts() {
-    /*
-    if (irq_pcint) {  // button pressed or released
-        // nothing to do here
-        // (PCINT only matters during standby)
-    }
-    */
-    if (irq_adc) {  // ADC done measuring
-        adc_deferred();
-        // irq_adc = 0;  // takes care of itself
-    }
-    if (irq_wdt) {  // the clock ticked
-        WDT_inner();
-        // irq_wdt = 0;  // takes care of itself
-    }
-}
-
 #endif
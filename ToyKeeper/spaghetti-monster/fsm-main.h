@@ -21,7 +21,5 @@
 #define FSM_MAIN_H
 
 int main();
-// needs to run frequently to execute the logic for WDT and ADC and stuff
-void handle_deferred_interrupts();
 
 #endif
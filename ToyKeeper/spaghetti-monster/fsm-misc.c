@@ -59,6 +59,28 @@ uint8_t blink_digit(uint8_t num) {
 }
 #endif
 
+#if defined(USE_COROUTINES) && (defined(USE_BLINK_NUM) || defined(USE_BLINK_DIGIT))
+// same as blink_digit(), but as a coroutine
+uint8_t co_blink_digit(Coroutine *co, uint8_t num) {
+    static uint8_t blinks;
+    CO_BEGIN(co);
+
+    blinks = num;
+    if (! blinks) blinks = 1;
+    for (; blinks>0; blinks--) {
+        set_level(BLINK_BRIGHTNESS);
+        // "zero" digit gets a single short blink
+        if (! num) CO_DELAY_MS(co, 8);
+        else CO_SLEEP_MS(co, BLINK_SPEED * 2 / 12);
+        set_level(0);
+        CO_SLEEP_MS(co, BLINK_SPEED * 3 / 12);
+    }
+    CO_SLEEP_MS(co, BLINK_SPEED * 8 / 12);
+
+    CO_END(co);
+}
+#endif
+
 #ifdef USE_BLINK_BIG_NUM
 uint8_t blink_big_num(uint16_t num) {
     uint16_t digits[] = { 10000, 1000, 100, 10, 1 };
@@ -107,6 +129,28 @@ uint8_t blink_num(uint8_t num) {
 }
 #endif
 
+#if defined(USE_COROUTINES) && defined(USE_BLINK_NUM)
+// same as blink_num(), but as a coroutine
+uint8_t co_blink_num(Coroutine *co, uint8_t num) {
+    static Coroutine digit_co;
+    static uint8_t hundreds, tens, ones;
+    CO_BEGIN(co);
+
+    hundreds = num / 100;
+    num = num % 100;
+    tens = num / 10;
+    ones = num % 10;
+
+    if (hundreds)
+        CO_CALL(co, &digit_co, co_blink_digit(&digit_co, hundreds));
+    if (hundreds || tens)
+        CO_CALL(co, &digit_co, co_blink_digit(&digit_co, tens));
+    CO_CALL(co, &digit_co, co_blink_digit(&digit_co, ones));
+
+    CO_END(co);
+}
+#endif
+
 #ifdef USE_INDICATOR_LED
 void indicator_led(uint8_t lvl) {
     switch (lvl) {
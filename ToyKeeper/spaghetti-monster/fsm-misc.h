@@ -29,11 +29,17 @@ void auto_clock_speed();
 #define BLINK_BRIGHTNESS (MAX_LEVEL/6)
 #endif
 uint8_t blink_digit(uint8_t num);
+#ifdef USE_COROUTINES
+uint8_t co_blink_digit(Coroutine *co, uint8_t num);
+#endif
 #endif
 
 #ifdef USE_BLINK_NUM
 //#define USE_BLINK
 uint8_t blink_num(uint8_t num);
+#ifdef USE_COROUTINES
+uint8_t co_blink_num(Coroutine *co, uint8_t num);
+#endif
 #endif
 
 /*
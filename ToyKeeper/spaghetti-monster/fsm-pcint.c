@@ -82,17 +82,66 @@ inline void PCINT_off() {
     #error Unrecognized MCU type
 #endif
 
-    irq_pcint = 1;  // let deferred code know an interrupt happened
+    task_post(TASK_BUTTON);  // let deferred code know an interrupt happened
 
     //DEBUG_FLASH;
 
     // as it turns out, it's more reliable to detect pin changes from WDT
     // because PCINT itself tends to double-tap when connected to a
     // noisy / bouncy switch (so the content of this function has been
-    // moved to a separate function, called from WDT only)
+    // moved to a separate function, called from WDT and button_edge() only)
     // PCINT_inner(button_is_pressed());
 }
 
+#ifdef USE_FAST_BUTTON
+// wait for BP_SAMPLES matching readings in a row (~1ms), and return the
+// button state  (or 255 if it won't hold still)
+uint8_t button_debounce() {
+    // at full speed, or the delays take 4X as long at low levels
+    #ifdef USE_DYNAMIC_UNDERCLOCKING
+    clock_prescale_set(clock_div_1);
+    #endif
+    uint8_t value = ((SWITCH_PORT & (1<<SWITCH_PIN)) == 0);
+    uint8_t stable = 0;
+    for (uint8_t tries = 255; stable < BP_SAMPLES; tries--) {
+        if (! tries) { value = 255; break; }
+        _delay_loop_2(BOGOMIPS / BP_SAMPLES);
+        uint8_t now = ((SWITCH_PORT & (1<<SWITCH_PIN)) == 0);
+        if (now == value) stable ++;
+        else { value = now; stable = 0; }
+    }
+    #ifdef USE_DYNAMIC_UNDERCLOCKING
+    auto_clock_speed();
+    #endif
+    return value;
+}
+
+// called soon after a pin change, outside the ISR
+// (waits until the switch stops bouncing, then sends press/release events)
+// (PCINT used to be off while awake, because of occasional reboots on
+//  wakeup, probably from when the ISR called PCINT_inner() itself...
+//  now the ISR only posts TASK_BUTTON, and this runs later from the main
+//  loop, so a bouncy switch can't start the UI on top of itself)
+// (sim/golden/scripts/bounce.txt rattles the button to check for that)
+void button_edge() {
+    // (or give up if it won't hold still, and let WDT poll it later)
+    uint8_t value = button_debounce();
+    if (value == 255) return;
+
+    // bounced back to where it was?  nothing to do
+    if (value == button_last_state) return;
+
+    go_to_standby = 0;
+    PCINT_inner(value);
+
+    // restart the clock tick, so hold / release timeouts count from
+    // the edge instead of from whenever the last tick happened
+    // (costs a fraction of a tick each time, and on the 1-series PIT
+    //  this only restores the period, not the phase)
+    WDT_on();
+}
+#endif
+
 // should only be called from PCINT and/or WDT
 // (is a separate function to reduce code duplication)
 void PCINT_inner(uint8_t pressed) {
@@ -100,9 +149,23 @@ void PCINT_inner(uint8_t pressed) {
 
     // register the change, and send event to the current state callback
     if (pressed) {  // user pressed button
+        #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+        // how long since the last click was released?
+        // (if the sequence already timed out, the counter was reset then)
+        if (click_gap_open) {
+            uint16_t gap = ticks_since_last_event;
+            if (! current_event) gap += release_timeout;
+            learn_click_gap(gap);
+            click_gap_open = 0;
+        }
+        #endif
         push_event(B_PRESS);
         emit_current_event(0);
     } else {  // user released button
+        #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+        // only clicks count, not holds
+        click_gap_open = ! (current_event & B_HOLD);
+        #endif
         // how long was the button held?
         push_event(B_RELEASE);
         emit_current_event(ticks_since_last_event);
@@ -20,7 +20,6 @@
 #ifndef FSM_PCINT_H
 #define FSM_PCINT_H
 
-volatile uint8_t irq_pcint = 0;  // pin change interrupt happened?
 //static volatile uint8_t button_was_pressed;
 #define BP_SAMPLES 32
 volatile uint8_t button_last_state;
@@ -28,5 +27,9 @@ uint8_t button_is_pressed();
 inline void PCINT_on();
 inline void PCINT_off();
 void PCINT_inner(uint8_t pressed);
+#ifdef USE_FAST_BUTTON
+// react to button edges right away, instead of waiting for the next tick
+void button_edge();
+#endif
 
 #endif
@@ -23,6 +23,65 @@
 
 #ifdef USE_RAMPING
 
+#ifdef USE_PACKED_RAMPS
+// read one level from a table made by bin/ramp_pack.py
+// (which is: first, count, top, a jump for each group of 16 levels after
+//  the first, then one delta per level in the span)
+// (jumps to the level's group, so it never adds up more than 16 deltas)
+PWM_DATATYPE ramp_unpack(const uint8_t *table, uint8_t level) {
+    uint8_t first = pgm_read_byte(table);
+    uint8_t count = pgm_read_byte(table + 1);
+    const uint8_t *p = table + 2;
+    PWM_DATATYPE value;
+
+    #if PACKED_PWM_BITS > 8
+    #define RAMP_UNPACK_VALUE() pgm_read_word(p)
+    #define RAMP_UNPACK_WIDTH 2
+    #else
+    #define RAMP_UNPACK_VALUE() pgm_read_byte(p)
+    #define RAMP_UNPACK_WIDTH 1
+    #endif
+
+    // the top level is stored separately, since it's often different
+    if (level >= RAMP_SIZE - 1) return RAMP_UNPACK_VALUE();
+    if (level < first) return 0;
+    level -= first;
+    // levels past the span stay where the span ended
+    if (level >= count) level = count - 1;
+
+    p += RAMP_UNPACK_WIDTH;
+    // skip past the jumps, and then to the level's group of 16
+    uint8_t group = level >> 4;
+    uint8_t jump = group ? pgm_read_byte(p + group - 1) : 0;
+    p += ((count - 1) >> 4) + jump;
+    level &= 15;
+    value = 0;
+    while (1) {
+        int8_t delta = pgm_read_byte(p);
+        p ++;
+        if (delta == -128) {  // too big for a delta, so the whole value
+            value = RAMP_UNPACK_VALUE();
+            p += RAMP_UNPACK_WIDTH;
+        }
+        else value += delta;
+        if (! level--) return value;
+    }
+    #undef RAMP_UNPACK_VALUE
+    #undef RAMP_UNPACK_WIDTH
+}
+#endif
+
+#ifdef USE_PWM_DITHER
+// once per PWM cycle:  add the fraction, and go one step higher whenever
+// it carries  (so 4/16 is base+1 for one cycle out of every 4)
+// (the pattern repeats every 16 cycles or less, which is too fast to see)
+ISR(PWM_DITHER_VECT) {
+    uint8_t acc = dither_acc + dither_frac;
+    PWM1_LVL = dither_base + (acc < dither_acc);
+    dither_acc = acc;
+}
+#endif
+
 void set_level(uint8_t level) {
     #ifdef USE_JUMP_START
     // maybe "jump start" the engine, if it's prone to slow starts
@@ -80,6 +139,10 @@ void set_level(uint8_t level) {
     uint8_t api_level = level;
     #endif
 
+    #ifdef USE_PWM_DITHER
+    PWM_DITHER_OFF();
+    #endif
+
     //TCCR0A = PHASE;
     if (level == 0) {
         #if PWM_CHANNELS >= 1
@@ -179,6 +242,20 @@ void set_level(uint8_t level) {
         PWM4_LVL = PWM_GET(pwm4_levels, level);
         #endif
 
+        #ifdef USE_PWM_DITHER
+        // fill in the space between this level's PWM value and the next
+        if (level < PWM_DITHER_LEVELS) {
+            int8_t d = pgm_read_byte(pwm1_dither + level);
+            if (d) {
+                dither_base = PWM1_LVL;
+                // below the table value, so go from one step lower
+                if (d < 0) { dither_base --; d += 16; }
+                dither_frac = d << 4;
+                PWM_DITHER_ON();
+            }
+        }
+        #endif
+
         #ifdef USE_DYN_PWM
             uint16_t top = PWM_GET(pwm_tops, level);
             #if defined(PWM1_CNT) && defined(PWM1_PHASE_SYNC)
@@ -260,9 +337,18 @@ void gradual_tick() {
     #endif
     */
 
+    #ifdef USE_PWM_DITHER
+    // hold still while adjusting, so the ISR doesn't undo it
+    // (set_level() starts it again when the next level is reached)
+    PWM_DITHER_OFF();
+    #endif
+
     gt --;  // convert 1-based number to 0-based
 
     PWM_DATATYPE target;
+    // (remember whether each channel reached its target, instead of
+    //  reading the ramp tables again, since packed ramps are slower)
+    uint8_t reached = 1;
 
     #if PWM_CHANNELS >= 1
     target = PWM_GET(pwm1_levels, gt);
@@ -274,6 +360,7 @@ void gradual_tick() {
         #endif
     if (PWM1_LVL < target) PWM1_LVL ++;
     else if (PWM1_LVL > target) PWM1_LVL --;
+    reached &= (PWM1_LVL == target);
     #endif
     #if PWM_CHANNELS >= 2
     target = PWM_GET(pwm2_levels, gt);
@@ -285,31 +372,24 @@ void gradual_tick() {
         #endif
     if (PWM2_LVL < target) PWM2_LVL ++;
     else if (PWM2_LVL > target) PWM2_LVL --;
+    reached &= (PWM2_LVL == target);
     #endif
     #if PWM_CHANNELS >= 3
     target = PWM_GET(pwm3_levels, gt);
     if (PWM3_LVL < target) PWM3_LVL ++;
     else if (PWM3_LVL > target) PWM3_LVL --;
+    reached &= (PWM3_LVL == target);
     #endif
     #if PWM_CHANNELS >= 4
     target = PWM_GET(pwm4_levels, gt);
     if (PWM4_LVL < target) PWM4_LVL ++;
     else if (PWM4_LVL > target) PWM4_LVL --;
+    reached &= (PWM4_LVL == target);
     #endif
 
     // did we go far enough to hit the next defined ramp level?
     // if so, update the main ramp level tracking var
-    if ((PWM1_LVL == PWM_GET(pwm1_levels, gt))
-        #if PWM_CHANNELS >= 2
-            && (PWM2_LVL == PWM_GET(pwm2_levels, gt))
-        #endif
-        #if PWM_CHANNELS >= 3
-            && (PWM3_LVL == PWM_GET(pwm3_levels, gt))
-        #endif
-        #if PWM_CHANNELS >= 4
-            && (PWM4_LVL == PWM_GET(pwm4_levels, gt))
-        #endif
-        )
+    if (reached)
     {
         //actual_level = gt + 1;
         uint8_t orig = gradual_target;
@@ -70,6 +70,42 @@ void update_tint();
     #define PWM_GET(x,y) pgm_read_word(x+y)
 #endif
 
+// ramp tables generated by the build, from the cfg's "RAMP:" line
+// (anything the cfg defines itself takes precedence)
+#ifdef RAMPFILE
+#include RAMPFILE
+#endif
+
+#ifdef USE_PACKED_RAMPS
+// ramp tables packed by bin/ramp_pack.py, which take less space
+// but have to be decoded one level at a time by ramp_unpack()
+// (8-bit tables work with 16-bit PWM too, but not the other way around)
+#if (PACKED_PWM_BITS > 8) && (PWM_BITS <= 8)
+#error "Packed ramps have values over 255, which don't fit in PWM_BITS."
+#endif
+#ifndef RAMP_SIZE
+#error "Packed ramps need RAMP_SIZE."
+#endif
+#undef PWM_GET
+#define PWM_GET(x,y) ramp_unpack(x,y)
+PWM_DATATYPE ramp_unpack(const uint8_t *table, uint8_t level);
+#ifdef PWM1_PACKED
+PROGMEM const uint8_t pwm1_levels[] = { PWM1_PACKED };
+#endif
+#ifdef PWM2_PACKED
+PROGMEM const uint8_t pwm2_levels[] = { PWM2_PACKED };
+#endif
+#ifdef PWM3_PACKED
+PROGMEM const uint8_t pwm3_levels[] = { PWM3_PACKED };
+#endif
+#ifdef PWM4_PACKED
+PROGMEM const uint8_t pwm4_levels[] = { PWM4_PACKED };
+#endif
+#ifdef USE_DYN_PWM
+PROGMEM const uint8_t pwm_tops[] = { PWM_TOPS_PACKED };
+#endif
+
+#else  // regular ramp tables
 // use UI-defined ramp tables if they exist
 #ifdef PWM1_LEVELS
 PROGMEM const PWM_DATATYPE pwm1_levels[] = { PWM1_LEVELS };
@@ -89,6 +125,37 @@ PROGMEM const PWM_DATATYPE pwm4_levels[] = { PWM4_LEVELS };
 #ifdef USE_DYN_PWM
 PROGMEM const PWM_DATATYPE pwm_tops[] = { PWM_TOPS };
 #endif
+#endif  // ifdef USE_PACKED_RAMPS
+
+#ifdef USE_PWM_DITHER
+// temporal dithering for the bottom of the ramp:
+// alternate between two adjacent PWM values, to get the levels in between
+// PWM1_DITHER has one value per level, starting at level 1:  how far the
+// real level is from PWM1_LEVELS, in 16ths of a PWM step (-8 to 8)
+// (level_calc.py --dither N makes it)
+#ifndef PWM1_DITHER
+#error "USE_PWM_DITHER needs PWM1_DITHER.  Try level_calc.py --dither N."
+#endif
+#ifdef USE_TINT_RAMPING
+#error "USE_PWM_DITHER doesn't work with USE_TINT_RAMPING."
+#endif
+PROGMEM const int8_t pwm1_dither[] = { PWM1_DITHER };
+#define PWM_DITHER_LEVELS sizeof(pwm1_dither)
+// the interrupt which fires once per PWM cycle, and how to turn it on/off
+// (hwdefs can define their own, on anything besides a tiny85)
+#ifndef PWM_DITHER_VECT
+  #if ((ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85)) && (PWM1_PIN != PB4)
+    #define PWM_DITHER_VECT TIMER0_OVF_vect
+    #define PWM_DITHER_ON() (TIMSK |= (1 << TOIE0))
+    #define PWM_DITHER_OFF() (TIMSK &= ~(1 << TOIE0))
+  #else
+    #error "USE_PWM_DITHER needs PWM_DITHER_VECT, _ON(), and _OFF() in the hwdef"
+  #endif
+#endif
+volatile PWM_DATATYPE dither_base;  // PWM1_LVL is this or this + 1
+volatile uint8_t dither_frac;  // ... this many 256ths of the time
+uint8_t dither_acc;
+#endif
 
 #ifdef USE_JUMP_START
 #ifndef JUMP_START_TIME
@@ -101,7 +168,7 @@ uint8_t jump_start_level = DEFAULT_JUMP_START_LEVEL;
 #endif
 
 // default / example ramps
-#ifndef PWM1_LEVELS
+#if !defined(PWM1_LEVELS) && !defined(USE_PACKED_RAMPS)
 #if PWM_CHANNELS == 1
   #if RAMP_LENGTH == 50
     // ../../bin/level_calc.py 1 50 7135 3 0.25 980
@@ -167,7 +234,9 @@ uint8_t jump_start_level = DEFAULT_JUMP_START_LEVEL;
 #endif
 
 // RAMP_SIZE / MAX_LVL
+#ifndef USE_PACKED_RAMPS
 #define RAMP_SIZE (sizeof(pwm1_levels)/sizeof(PWM_DATATYPE))
+#endif
 #define MAX_LEVEL RAMP_SIZE
 
 void set_level(uint8_t level);
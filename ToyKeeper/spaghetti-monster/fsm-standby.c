@@ -42,14 +42,17 @@ void sleep_until_eswitch_pressed()
     // make sure switch isn't currently pressed
     while (button_is_pressed()) {}
     empty_event_sequence();  // cancel pending input on suspend
+    #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+    // ticks stop while asleep, so the next click's gap can't be measured
+    // (it'd look much shorter than it really was)
+    click_gap_open = 0;
+    #endif
 
     PCINT_on();  // wake on e-switch event
 
     #ifdef TICK_DURING_STANDBY
     // detect which type of event caused a wake-up
-    irq_adc = 0;
-    irq_wdt = 0;
-    irq_pcint = 0;
+    tasks_pending = 0;
     while (go_to_standby) {
     #else
         go_to_standby = 0;
@@ -69,21 +72,19 @@ void sleep_until_eswitch_pressed()
 
     #ifdef TICK_DURING_STANDBY
         // determine what woke us up...
-        if (irq_pcint) {  // button pressed; wake up
+        uint8_t pending = tasks_pending;
+        if (pending & TASK_BUTTON) {  // button pressed; wake up
             go_to_standby = 0;
         }
-        if (irq_adc) {  // ADC done measuring
+        if (pending & TASK_ADC) {  // ADC done measuring
             #ifndef USE_LOWPASS_WHILE_ASLEEP
             adc_reset = 1;  // don't lowpass while asleep
             #endif
             adc_deferred_enable = 1;
-            adc_deferred();
             //ADC_off();  // takes care of itself
-            //irq_adc = 0;  // takes care of itself
-        }
-        if (irq_wdt) {  // generate a sleep tick
-            WDT_inner();
         }
+        // ... and handle it  (the WDT generates a sleep tick)
+        run_tasks();
     }
     #endif
 
@@ -94,7 +95,10 @@ void sleep_until_eswitch_pressed()
     // go back to normal running mode
     // PCINT not needed any more, and can cause problems if on
     // (occasional reboots on wakeup-by-button-press)
+    // (unless it's used for button edges while awake)
+    #ifndef USE_FAST_BUTTON
     PCINT_off();
+    #endif
     // restore normal awake-mode interrupts
     ADC_on();
     WDT_on();
@@ -39,6 +39,10 @@ void _set_state(StatePtr new_state, uint16_t arg,
     current_state = new_state;
     // call new state-enter hook (don't use stack)
     if (new_state != NULL) current_state(enter_event, arg);
+    #ifdef USE_EVENT_TRACE
+    // (leaving is implied, so only log the new state)
+    trace_event(enter_event, arg, state_stack_len-1);
+    #endif
 
     // since state changed, stop any animation in progress
     interrupt_nice_delays();
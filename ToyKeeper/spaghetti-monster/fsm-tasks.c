@@ -0,0 +1,72 @@
+/*
+ * fsm-tasks.c: Deferred work scheduler for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_TASKS_C
+#define FSM_TASKS_C
+
+// safe to call from ISRs and regular code
+inline void task_post(uint8_t task) {
+    uint8_t sreg = SREG;
+    cli();
+    tasks_pending |= task;
+    SREG = sreg;
+}
+
+void run_tasks() {
+    uint8_t done = 0;
+    uint8_t pending;
+
+    // run the most important task, then look again, in case something
+    // more important was posted meanwhile
+    // (each task runs at most once per call, so a busy ISR can't
+    //  keep us stuck here)
+    while ((pending = (tasks_pending & ~done))) {
+        uint8_t task = pending & (-pending);  // lowest bit
+        done |= task;
+
+        cli();
+        tasks_pending &= ~task;
+        sei();
+
+        if (task == TASK_ADC) {  // ADC done measuring
+            adc_deferred();
+        }
+
+        else if (task == TASK_BUTTON) {  // button pressed or released
+            #ifdef USE_FAST_BUTTON
+            button_edge();
+            #else
+            // nothing to do here
+            // (PCINT only matters during standby)
+            #endif
+        }
+
+        else if (task == TASK_TICK) {  // the clock ticked
+            WDT_inner();
+        }
+
+        #ifdef RECIPE_TASKS
+        else {
+            recipe_task(task);
+        }
+        #endif
+    }
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * fsm-tasks.h: Deferred work scheduler for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_TASKS_H
+#define FSM_TASKS_H
+
+// ISRs do the bare minimum, then post a task to finish the job later.
+// Each task is one bit, and lower bits run first, so urgent things
+// (like LVP and thermal regulation) don't wait behind cosmetic things.
+#define TASK_ADC     0b00000001  // ADC measurement done  (LVP, thermal)
+#define TASK_BUTTON  0b00000010  // button changed  (PCINT)
+#define TASK_TICK    0b00000100  // clock tick  (WDT)
+// The rest are free for the recipe to use.  To use them,
+// #define RECIPE_TASKS (a mask of which bits it uses) and write a
+// function to run them:  void recipe_task(uint8_t task);
+#ifdef RECIPE_TASKS
+#if (RECIPE_TASKS & (TASK_ADC | TASK_BUTTON | TASK_TICK))
+#error RECIPE_TASKS overlaps FSM tasks
+#endif
+void recipe_task(uint8_t task);
+#endif
+
+volatile uint8_t tasks_pending = 0;
+
+inline void task_post(uint8_t task);
+// run whatever is pending, most important first
+// (needs to run frequently to execute the logic for WDT and ADC and stuff)
+void run_tasks();
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * fsm-timers.c: Software timer functions for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_TIMERS_C
+#define FSM_TIMERS_C
+
+#ifdef USE_TIMERS
+
+void timer_set(uint8_t id, uint16_t ticks, uint8_t flags) {
+    Timer *t = timers + id;
+    t->remaining = ticks;
+    t->period = 0;
+    if (flags & TIMER_PERIODIC) t->period = ticks;
+    t->flags = flags;
+}
+
+inline void timer_stop(uint8_t id) {
+    timers[id].remaining = 0;
+}
+
+inline uint16_t timer_remaining(uint8_t id) {
+    return timers[id].remaining;
+}
+
+void timers_tick(uint8_t clock) {
+    Timer *t = timers;
+    for (uint8_t id=0; id<NUM_TIMERS; id++, t++) {
+        // skip timers which aren't running, or which use the other clock
+        if (! t->remaining) continue;
+        if ((t->flags & TIMER_SLEEP) != clock) continue;
+        // not done yet?
+        if (--t->remaining) continue;
+        // time's up; restart it if periodic, then let the UI know
+        t->remaining = t->period;
+        emit(EV_timer, id);
+    }
+}
+
+#endif  // ifdef USE_TIMERS
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * fsm-timers.h: Software timer functions for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_TIMERS_H
+#define FSM_TIMERS_H
+
+#ifdef USE_TIMERS
+
+// Define NUM_TIMERS in your SpaghettiMonster recipe, to say how many
+// timer slots it needs.  (can be a #define or the last item in an enum)
+// Timer IDs are 0 to NUM_TIMERS-1, and are sent as the arg of EV_timer.
+
+// flags for timer_set()
+#define TIMER_ONESHOT   0b00000000  // fire once, then stop
+#define TIMER_PERIODIC  0b00000001  // fire every N ticks until stopped
+#define TIMER_SLEEP     0b00000010  // count sleep ticks instead of awake ticks
+
+typedef struct Timer {
+    uint16_t remaining;  // ticks until it fires  (0 = not running)
+    uint16_t period;     // reload value after firing  (0 = one-shot)
+    uint8_t flags;
+} Timer;
+
+Timer timers[NUM_TIMERS];
+
+// start (or restart) a timer, which sends EV_timer with arg=id when done
+void timer_set(uint8_t id, uint16_t ticks, uint8_t flags);
+inline void timer_stop(uint8_t id);
+// 0 if the timer isn't running, otherwise ticks until it fires
+inline uint16_t timer_remaining(uint8_t id);
+#define timer_active(id) (timer_remaining(id) != 0)
+// count down all timers on the given clock (0 or TIMER_SLEEP)
+// (only for use by WDT_inner())
+void timers_tick(uint8_t clock);
+
+#endif  // ifdef USE_TIMERS
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * fsm-trace.c: Crash-surviving event trace for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_TRACE_C
+#define FSM_TRACE_C
+
+#ifdef USE_EVENT_TRACE
+
+#ifdef AVRXMEGA3  // ATTINY816, 817, etc
+#define TRACE_RESET_FLAGS RSTCTRL.RSTFR
+#define TRACE_PORF RSTCTRL_PORF_bm
+#define TRACE_WDRF RSTCTRL_WDRF_bm
+#else
+#define TRACE_RESET_FLAGS MCUSR
+#define TRACE_PORF (1<<PORF)
+#define TRACE_WDRF (1<<WDRF)
+#endif
+
+static inline void trace_event(Event event, uint16_t arg, uint8_t state) {
+    #ifndef TRACE_TICKS
+    // ticks and hold repeats would flush everything else out in
+    // a fraction of a second, so only keep the start of each hold
+    if ((event == EV_tick) || (event == EV_sleep_tick)) return;
+    if (((event & (B_CLICK|B_HOLD|B_PRESS)) == (B_CLICK|B_HOLD|B_PRESS))
+        && arg) return;
+    #endif
+    TraceEntry *t = trace + trace_pos;
+    trace_pos = (trace_pos + 1) & (TRACE_LEN - 1);
+    t->tick = trace_ticks;
+    t->event = event;
+    t->arg = arg;
+    t->state = state;
+}
+
+static inline void trace_boot(uint8_t flags) {
+    uint8_t crashed = 0;
+
+    // after power-on, RAM is random, so start over
+    if ((trace_magic != TRACE_MAGIC) || (flags & TRACE_PORF)) {
+        trace_magic = TRACE_MAGIC;
+        trace_pos = 0;
+        uint8_t *t = (uint8_t *)trace;
+        for (uint8_t i=0; i<TRACE_LEN*4; i++) t[i] = 0;  // (all 0 = empty)
+    }
+    // watchdog reset, or a wild jump to 0 (no flags at all)
+    else if ((flags & TRACE_WDRF) || (! flags)) crashed = 1;
+
+    // the flags pile up until cleared, and a leftover PORF would make
+    // every later crash look like a power-on
+    #ifdef AVRXMEGA3
+    RSTCTRL.RSTFR = flags;  // (write 1 to clear)
+    #else
+    MCUSR = 0;
+    #endif
+
+    trace_event(EV_none, flags, TRACE_BOOT);
+
+    if (crashed) {
+        // only writes bytes which changed, to reduce wear
+        eeprom_update_byte((uint8_t *)TRACE_EEP_START, TRACE_EEP_MARKER);
+        eeprom_update_byte((uint8_t *)(TRACE_EEP_START+1), trace_pos);
+        eeprom_update_block((const void *)trace,
+                            (void *)(TRACE_EEP_START+2),
+                            TRACE_LEN*4);
+    }
+}
+
+#endif  // ifdef USE_EVENT_TRACE
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * fsm-trace.h: Crash-surviving event trace for SpaghettiMonster.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_TRACE_H
+#define FSM_TRACE_H
+
+#ifdef USE_EVENT_TRACE
+
+// Remembers the last few events in a ring buffer which isn't cleared
+// at boot, so it survives a watchdog reset (crash or reboot()).
+// After such a reset, it gets copied to the end of the EEPROM, where
+// bin/trace-decode.py can read it from an EEPROM dump.
+
+// how many events to remember  (must be a power of 2)
+#ifndef TRACE_LEN
+#define TRACE_LEN 16
+#endif
+#if (TRACE_LEN & (TRACE_LEN-1))
+#error TRACE_LEN must be a power of 2
+#endif
+
+typedef struct TraceEntry {
+    uint8_t tick;   // trace_ticks when the event was handled
+    Event event;
+    uint8_t arg;    // (low byte only)
+    uint8_t state;  // state stack index of the handler  (0xFF = unhandled)
+} TraceEntry;
+
+// special entry, added at boot:  event = EV_none, arg = reset flags
+#define TRACE_BOOT 0xFE  // (in the "state" field)
+
+// not cleared at boot, so check the magic number before trusting it
+#define TRACE_MAGIC 0x7ACE
+#define NOINIT __attribute__ ((section (".noinit")))
+TraceEntry trace[TRACE_LEN] NOINIT;
+uint8_t trace_pos NOINIT;  // next slot to write
+uint16_t trace_magic NOINIT;
+
+// free-running clock for timestamps  (wraps every ~4 seconds)
+uint8_t trace_ticks = 0;
+
+// EEPROM copy:  marker, trace_pos, then the raw entries
+#define TRACE_EEP_MARKER 0b01011010
+#define TRACE_EEP_BYTES (2 + (TRACE_LEN*4))
+#define TRACE_EEP_START (EEPSIZE - TRACE_EEP_BYTES)
+#if defined(USE_EEPROM) && ((EEP_START + EEPROM_BYTES + 1) > TRACE_EEP_START)
+#error EEPROM too small for TRACE_LEN
+#endif
+
+// call from emit_now(), after the event was handled
+static inline void trace_event(Event event, uint16_t arg, uint8_t state);
+// call at boot, after the WDT is off, with the reset flags from before
+// prevent_reboot_loop() cleared them
+static inline void trace_boot(uint8_t flags);
+
+#endif  // ifdef USE_EVENT_TRACE
+
+#endif
@@ -102,12 +102,10 @@ ISR(RTC_PIT_vect) {
 #else
 ISR(WDT_vect) {
 #endif
-    irq_wdt = 1;  // WDT event happened
+    task_post(TASK_TICK);  // WDT event happened
 }
 
 void WDT_inner() {
-    irq_wdt = 0;  // WDT event handled; reset flag
-
     static uint8_t adc_trigger = 0;
 
     // cache this here to reduce ROM size, because it's volatile
@@ -118,6 +116,13 @@ void WDT_inner() {
     // copy back to the original
     ticks_since_last_event = ticks_since_last;
 
+    #ifdef USE_COROUTINES
+    co_ticks ++;
+    #endif
+    #ifdef USE_EVENT_TRACE
+    trace_ticks ++;
+    #endif
+
     // detect and emit button change events (even during standby)
     uint8_t was_pressed = button_last_state;
     uint8_t pressed = button_is_pressed();
@@ -131,6 +136,9 @@ void WDT_inner() {
     #ifdef TICK_DURING_STANDBY
     // handle standby mode specially
     if (go_to_standby) {
+        #ifdef USE_TIMERS
+        timers_tick(TIMER_SLEEP);
+        #endif
         // emit a sleep tick, and process it
         emit(EV_sleep_tick, ticks_since_last);
         process_emissions();
@@ -152,6 +160,10 @@ void WDT_inner() {
     // append timeout to current event sequence, then
     // send event to current state callback
 
+    #ifdef USE_TIMERS
+    timers_tick(0);
+    #endif
+
     // callback on each timer tick
     if ((current_event & B_FLAGS) == (B_CLICK | B_HOLD | B_PRESS)) {
         emit(EV_tick, 0);  // override tick counter while holding button
@@ -186,7 +198,7 @@ void WDT_inner() {
             empty_event_sequence();
         }
         // end and clear event after release timeout
-        else if (ticks_since_last >= RELEASE_TIMEOUT) {
+        else if (ticks_since_last >= RELEASE_TIMEOUT_NOW) {
             current_event |= B_TIMEOUT;
             emit_current_event(0);
             empty_event_sequence();
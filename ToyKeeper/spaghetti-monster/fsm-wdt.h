@@ -25,7 +25,6 @@
 void WDT_on();
 inline void WDT_off();
 
-volatile uint8_t irq_wdt = 0;  // WDT interrupt happened?
 
 #ifdef TICK_DURING_STANDBY
   #if defined(USE_INDICATOR_LED) || defined(USE_AUX_RGB_LEDS)
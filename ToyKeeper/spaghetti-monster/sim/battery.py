@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+
+"""Checks low-voltage protection on each build target, in the simulator.
+
+Run it from the program's directory:
+
+    ../sim/battery.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the program with
+sim-battery.c, runs every scenario in sim/battery/ on a simulated
+battery, and prints a table:  how long the light ran before LVP turned
+it off, when LVP first stepped down, how many stepdowns it made, how
+often it went back up on its own (which means something is fighting
+LVP), and how much charge it used.  The load comes from
+sim/energy-models.txt, and the battery from sim/battery-models.txt.
+
+Options:
+    --soc N         start at N percent charge  (default 100)
+    --scenario F    run only this script  (can be repeated)
+    -D FOO          build with an extra flag  (or -UFOO;  can be repeated)
+"""
+
+from __future__ import print_function
+
+import os
+import re
+import subprocess
+import sys
+
+SIM = os.path.dirname(os.path.abspath(__file__))
+ENERGY_MODELS = os.path.join(SIM, 'energy-models.txt')
+BATTERY_MODELS = os.path.join(SIM, 'battery-models.txt')
+SEARCH = ['.', '..', '../..', '../../..']
+
+
+def main(args):
+    """Build, run, and tabulate each target"""
+    scenarios = []
+    flags = []
+    extra = []
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--soc':
+            extra.append('soc=' + args.pop(0))
+        elif arg == '--scenario':
+            scenarios.append(os.path.abspath(args.pop(0)))
+        elif arg in ('-D', '-U'):
+            flags.append(arg + args.pop(0))
+        elif arg.startswith('-D') or arg.startswith('-U'):
+            flags.append(arg)
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+    if not scenarios:
+        d = os.path.join(SIM, 'battery')
+        scenarios = [os.path.join(d, f) for f in sorted(os.listdir(d))
+                     if f.endswith('.txt')]
+
+    loads = load_models(ENERGY_MODELS)
+    batteries = load_models(BATTERY_MODELS)
+    out = 'battery-out'
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    print('%-28s %-10s %9s %9s %6s %6s %7s %6s' % (
+        'target', 'scenario', 'runtime', 'first', 'steps', 'rises',
+        'mAh', 'left%'))
+
+    failed = []
+    bouncy = []
+    for cfg in sorted(os.listdir('.')):
+        if not (cfg.startswith('cfg-') and cfg.endswith('.h')):
+            continue
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        load = find_model(cfg, loads)
+        binary = build(cfg, name, out, flags)
+        if not load or not binary:
+            failed.append(name + (binary and ' (no model)' or ' (build)'))
+            continue
+        model = load + (find_model(cfg, batteries) or []) + extra
+
+        for scenario in scenarios:
+            scenario_name = os.path.basename(scenario)[:-4]
+            r = simulate(binary, model, scenario)
+            if not r:
+                print('%-28s %-10s %s' % (name, scenario_name, 'error'))
+                continue
+            if r['rises']:
+                bouncy.append('%s (%s)' % (name, scenario_name))
+            print('%-28s %-10s %9s %9s %6i %6i %7.0f %6.1f' % (
+                name, scenario_name, hms(r['runtime']), hms(r['first']),
+                r['steps'], r['rises'], r['mah'], r['soc']))
+        sys.stdout.flush()
+
+    if bouncy:
+        print('Went back up during LVP: %s' % ', '.join(bouncy))
+    if failed:
+        print('Skipped: %s' % ', '.join(failed))
+    if bouncy or failed:
+        return 1
+    return 0
+
+
+def hms(seconds):
+    """1h02m03s, or "-" for never"""
+    if seconds < 0:
+        return '-'
+    s = int(seconds)
+    if s >= 3600:
+        return '%ih%02im%02is' % (s // 3600, (s // 60) % 60, s % 60)
+    return '%im%02is' % (s // 60, s % 60)
+
+
+def load_models(path):
+    """Read a *-models.txt file into {file: [name=value, ...]}"""
+    models = {}
+    for line in open(path):
+        line = line.split('#')[0].split()
+        if line:
+            models[line[0]] = line[1:]
+    return models
+
+
+def find_model(path, models, seen=None):
+    """Follow #includes from a cfg, and return the first model found"""
+    seen = seen or set()
+    if os.path.basename(path) in models:
+        return models[os.path.basename(path)]
+    if path in seen:
+        return None
+    seen.add(path)
+    for line in open(path):
+        m = re.match(r'^\s*#include\s+"([^"]+)"', line)
+        if not m:
+            continue
+        # like gcc:  next to this file first, then the -I dirs
+        dirs = [os.path.dirname(path)] + SEARCH
+        for d in dirs:
+            inc = os.path.normpath(os.path.join(d, m.group(1)))
+            if os.path.exists(inc):
+                found = find_model(inc, models, seen)
+                if found:
+                    return found
+                break
+    return None
+
+
+def build(cfg, name, out, flags):
+    """Build one target with the battery driver"""
+    env = dict(os.environ)
+    env['SIM_DRIVER'] = os.path.join(SIM, 'sim-battery.c')
+    cmd = [os.path.join(SIM, 'build.sh'), 'anduril', cfg] + flags
+    proc = subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    proc.communicate()
+    if proc.returncode:
+        return None
+    binary = os.path.join(out, 'anduril.%s.sim' % name)
+    os.rename('anduril.%s.sim' % name, binary)
+    return binary
+
+
+def simulate(binary, model, scenario):
+    """Run a scenario, and return its "battery" line as a dict"""
+    proc = subprocess.Popen([binary] + model + [scenario],
+                            stdout=subprocess.PIPE)
+    text = proc.communicate()[0].decode('utf-8', 'replace')
+    for line in text.splitlines():
+        f = line.split()
+        if f[:1] == ['battery'] and len(f) == 7:
+            keys = ['runtime', 'first', 'steps', 'rises', 'mah', 'soc']
+            return dict(zip(keys, [float(x) for x in f[1:]]))
+    return None
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
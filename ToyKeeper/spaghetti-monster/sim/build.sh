@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# Builds an FSM program for the host, to run in the simulator.
+# Run it from the program's directory, like bin/build.sh:
+#   ../sim/build.sh anduril cfg-emisar-d4.h [extra CFLAGS]
+# ... which makes anduril.emisar-d4.sim
+# Set SIM_DRIVER to use a different main() than sim-run.c.
+# (and SIM_DRIVER_FLAGS / SIM_LDFLAGS for anything else it needs)
+
+if [ -z "$1" ]; then
+  echo "Usage: build.sh myprogram [cfg-file.h] [extra CFLAGS]"
+  exit
+fi
+
+PROGRAM=$1 ; shift
+CFG=$1 ; shift
+
+SIM=$(cd "$(dirname "$0")" && pwd)
+if [ -z "$SIM_DRIVER" ]; then SIM_DRIVER="$SIM/sim-run.c" ; fi
+
+# figure out MCU type, the same way build-all.sh does
+ATTINY=''
+NAME=sim
+if [ -n "$CFG" ]; then
+  ATTINY=$(grep 'ATTINY:' "$CFG" | awk '{ print $3 }')
+  NAME=$(echo "$CFG" | perl -ne '/cfg-(.*).h/ && print "$1\n";')
+  CFGFLAGS="-DCONFIGFILE=$CFG"
+fi
+if [ -z "$ATTINY" ]; then ATTINY=85 ; fi
+
+export CC=${CC:-gcc}
+export OBJCOPY=${OBJCOPY:-objcopy}
+# (no -Wall, because hwdef code does lots of int-to-pointer things which
+#  are fine on an AVR but not on a 64-bit host)
+export CFLAGS="-g -O1 -Wno-int-to-pointer-cast -std=gnu99 -fgnu89-inline -fshort-enums -fno-pie -fno-common -DATTINY=$ATTINY -I$SIM/include -I. -I.. -I../.. -I../../.. $CFGFLAGS"
+export LDFLAGS="-no-pie -lm $SIM_LDFLAGS"
+OUT=$PROGRAM.$NAME.sim
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# generated (and packed) ramp tables, the same way bin/build.sh does it
+function cfg_line () {
+  local LINE=$(grep -m 1 "$1" "$2")
+  if [ -z "$LINE" ]; then
+    for INC in $(sed -n 's/^#include "\([^"]*cfg-[^"]*\)".*/\1/p' "$2"); do
+      LINE=$(cfg_line "$1" "$(dirname "$2")/$INC")
+      if [ -n "$LINE" ]; then break ; fi
+    done
+  fi
+  echo $LINE
+}
+if [ -n "$CFG" ]; then
+  SPEC=$(cfg_line '^// RAMP:' "$CFG" | sed 's/^\/\/ RAMP://')
+  PACK=$(cfg_line '^#define USE_PACKED_RAMPS' "$CFG")
+fi
+if [ -n "$SPEC$PACK" ]; then
+  BIN="$SIM/../../../bin"
+  : > "$TMP/ramp.h"
+  if [ -n "$SPEC" ]; then
+    "$BIN/level_calc.py" --header $SPEC >> "$TMP/ramp.h" || exit 1
+  fi
+  if [ -n "$PACK" ]; then
+    PACKED=$("$BIN/ramp_pack.py" --header "$CFG" "$TMP/ramp.h") || exit 1
+    echo "$PACKED" >> "$TMP/ramp.h"
+  fi
+  export CFLAGS="$CFLAGS -DRAMPFILE=\"$TMP/ramp.h\""
+fi
+
+function run () {
+  echo $*
+  $*
+  if [ x"$?" != x0 ]; then exit 1 ; fi
+}
+
+run $CC $CFLAGS "-DSIM_PROGRAM=\"$PROGRAM.c\"" $* -c -o $TMP/fw.o $SIM/sim-fw.c
+# move the firmware's RAM into its own sections, so resets can wipe it
+run $OBJCOPY --rename-section .data=fw_data --rename-section .bss=fw_bss --rename-section .noinit=fw_noinit $TMP/fw.o
+run $CC $CFLAGS -Wall -c -o $TMP/sim.o $SIM/sim.c
+run $CC $CFLAGS -Wall -c -o $TMP/script.o $SIM/sim-script.c
+run $CC $CFLAGS -Wall -I$SIM $SIM_DRIVER_FLAGS -c -o $TMP/driver.o $SIM_DRIVER
+run $CC -o $OUT $TMP/fw.o $TMP/sim.o $TMP/script.o $TMP/driver.o $LDFLAGS
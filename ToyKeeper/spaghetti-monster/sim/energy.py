@@ -0,0 +1,170 @@
+#!/usr/bin/env python
+
+"""Estimates battery drain for each build target, in the simulator.
+
+Run it from the program's directory:
+
+    ../sim/energy.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the program with
+sim-energy.c, runs every scenario in sim/energy/, and prints a table of
+average current (mA) per target and scenario.  The light's electrical
+model comes from sim/energy-models.txt.
+
+Options:
+    --mah           show total mAh instead of average mA
+    --split         show MCU / LED / aux current separately
+    --scenario F    run only this script  (can be repeated)
+    -D FOO          build with an extra flag, like -DUSE_DYNAMIC_UNDERCLOCKING
+                    (or -UFOO;  can be repeated)
+"""
+
+from __future__ import print_function
+
+import os
+import re
+import subprocess
+import sys
+
+SIM = os.path.dirname(os.path.abspath(__file__))
+MODELS = os.path.join(SIM, 'energy-models.txt')
+SEARCH = ['.', '..', '../..', '../../..']
+
+
+def main(args):
+    """Build, run, and tabulate each target"""
+    scenarios = []
+    flags = []
+    column = 'avg'
+    split = False
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--mah':
+            column = 'mah'
+        elif arg == '--split':
+            split = True
+        elif arg == '--scenario':
+            scenarios.append(os.path.abspath(args.pop(0)))
+        elif arg in ('-D', '-U'):
+            flags.append(arg + args.pop(0))
+        elif arg.startswith('-D') or arg.startswith('-U'):
+            flags.append(arg)
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+    if not scenarios:
+        d = os.path.join(SIM, 'energy')
+        scenarios = [os.path.join(d, f) for f in sorted(os.listdir(d))
+                     if f.endswith('.txt')]
+
+    models = load_models()
+    out = 'energy-out'
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    names = [os.path.basename(s)[:-4] for s in scenarios]
+    unit = (column == 'mah') and 'mAh' or 'mA'
+    print('%-28s %s' % ('target  (%s)' % unit,
+                        ' '.join('%14s' % n for n in names)))
+
+    failed = []
+    for cfg in sorted(os.listdir('.')):
+        if not (cfg.startswith('cfg-') and cfg.endswith('.h')):
+            continue
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        model = find_model(cfg, models)
+        binary = build(cfg, name, out, flags)
+        if not model or not binary:
+            failed.append(name + (binary and ' (no model)' or ' (build)'))
+            continue
+
+        cells = []
+        for scenario in scenarios:
+            result = simulate(binary, model, scenario)
+            if not result:
+                cells.append('%14s' % 'error')
+            elif split:
+                cells.append('%14s' % ('%.3g/%.3g/%.3g' % (
+                    result['mcu'], result['led'], result['aux'])))
+            else:
+                cells.append('%14.4f' % result[column])
+        print('%-28s %s' % (name, ' '.join(cells)))
+        sys.stdout.flush()
+
+    if split:
+        print('(MCU / LEDs / aux, in mA)')
+    if failed:
+        print('Skipped: %s' % ', '.join(failed))
+        return 1
+    return 0
+
+
+def load_models():
+    """Read energy-models.txt into {file: [name=mA, ...]}"""
+    models = {}
+    for line in open(MODELS):
+        line = line.split('#')[0].split()
+        if line:
+            models[line[0]] = line[1:]
+    return models
+
+
+def find_model(path, models, seen=None):
+    """Follow #includes from a cfg, and return the first model found"""
+    seen = seen or set()
+    if os.path.basename(path) in models:
+        return models[os.path.basename(path)]
+    if path in seen:
+        return None
+    seen.add(path)
+    for line in open(path):
+        m = re.match(r'^\s*#include\s+"([^"]+)"', line)
+        if not m:
+            continue
+        # like gcc:  next to this file first, then the -I dirs
+        dirs = [os.path.dirname(path)] + SEARCH
+        for d in dirs:
+            inc = os.path.normpath(os.path.join(d, m.group(1)))
+            if os.path.exists(inc):
+                found = find_model(inc, models, seen)
+                if found:
+                    return found
+                break
+    return None
+
+
+def build(cfg, name, out, flags):
+    """Build one target with the energy driver"""
+    env = dict(os.environ)
+    env['SIM_DRIVER'] = os.path.join(SIM, 'sim-energy.c')
+    cmd = [os.path.join(SIM, 'build.sh'), 'anduril', cfg] + flags
+    proc = subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    proc.communicate()
+    if proc.returncode:
+        return None
+    binary = os.path.join(out, 'anduril.%s.sim' % name)
+    os.rename('anduril.%s.sim' % name, binary)
+    return binary
+
+
+def simulate(binary, model, scenario):
+    """Run a scenario, and return its "energy" line as a dict"""
+    proc = subprocess.Popen([binary] + model + [scenario],
+                            stdout=subprocess.PIPE)
+    text = proc.communicate()[0].decode('utf-8', 'replace')
+    for line in text.splitlines():
+        f = line.split()
+        if f[:1] == ['energy'] and len(f) == 7:
+            keys = ['seconds', 'avg', 'mah', 'mcu', 'led', 'aux']
+            return dict(zip(keys, [float(x) for x in f[1:]]))
+    return None
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+
+"""Fuzzes the button / event handling of each build target.
+
+Run it from the program's directory:
+
+    ../sim/fuzz.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the program with
+sim/sim-fuzz.c and gcc's coverage instrumentation, re-runs every input
+in sim/fuzz/corpus/, then spends a while mutating them to find new
+paths through the firmware.  Inputs which reach new code get added to
+the corpus, so it grows over time...  commit them.
+
+Anything which breaks an invariant (queue overflow, full state stack,
+LVP or thermal regulation not stepping down, LEDs stuck on, hangs, etc)
+gets saved in fuzz-out/NAME/.  To see what it did:
+
+    fuzz-out/anduril.NAME.sim -v fuzz-out/NAME/crash-...
+
+Options:
+    -t SECONDS      time to spend on each target  (default 30)
+    -l BYTES        longest input to try  (default 64)
+    -s SEED         random seed
+    --corpus DIR    use a different corpus
+    -D FOO          build with an extra flag  (or -UFOO;  can be repeated)
+"""
+
+from __future__ import print_function
+
+import os
+import subprocess
+import sys
+
+SIM = os.path.dirname(os.path.abspath(__file__))
+
+
+def main(args):
+    """Build and fuzz each target"""
+    seconds = '30'
+    extra = []
+    flags = []
+    corpus = os.path.join(SIM, 'fuzz', 'corpus')
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg in ('-t', '-l', '-s'):
+            if arg == '-t':
+                seconds = args.pop(0)
+            else:
+                extra += [arg, args.pop(0)]
+        elif arg == '--corpus':
+            corpus = os.path.abspath(args.pop(0))
+        elif arg in ('-D', '-U'):
+            flags.append(arg + args.pop(0))
+        elif arg.startswith('-D') or arg.startswith('-U'):
+            flags.append(arg)
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+
+    out = 'fuzz-out'
+    if not os.path.isdir(out):
+        os.mkdir(out)
+    if not os.path.isdir(corpus):
+        os.makedirs(corpus)
+
+    print('%-28s %8s %8s %8s %8s  %s' % (
+        'target', 'runs', 'edges', 'corpus', 'new', 'result'))
+    broken = []
+    skipped = []
+    for cfg in sorted(os.listdir('.')):
+        if not (cfg.startswith('cfg-') and cfg.endswith('.h')):
+            continue
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        binary = build(cfg, name, out, flags)
+        if not binary:
+            skipped.append(name)
+            continue
+        crashes = os.path.join(out, name)
+        if not os.path.isdir(crashes):
+            os.mkdir(crashes)
+
+        cmd = [binary, '-t', seconds] + extra + [corpus, crashes]
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT)
+        text = proc.communicate()[0].decode('utf-8', 'replace')
+        stats = ['-'] * 4
+        result = 'ok'
+        for line in text.splitlines():
+            f = line.split()
+            if f[:1] == ['fuzz'] and len(f) == 6:
+                stats = f[1:5]
+            elif ': ' in line and not line.startswith(('#', 'saved')):
+                result = line.split(': ', 1)[1]
+            elif line.startswith('saved '):
+                result += '  (%s)' % line[6:]
+        if proc.returncode:
+            broken.append(name)
+            if result == 'ok':
+                result = 'exit status %i' % proc.returncode
+        print('%-28s %8s %8s %8s %8s  %s' % tuple([name] + stats + [result]))
+        sys.stdout.flush()
+
+    print('')
+    print('Broken: %s  Skipped: %s' % (
+        ' '.join(broken) or '-', ' '.join(skipped) or '-'))
+    if broken:
+        return 1
+    return 0
+
+
+def build(cfg, name, out, flags):
+    """Build one target with the fuzzing driver"""
+    env = dict(os.environ)
+    env['SIM_DRIVER'] = os.path.join(SIM, 'sim-fuzz.c')
+    cmd = [os.path.join(SIM, 'build.sh'), 'anduril', cfg,
+           '-fsanitize-coverage=trace-pc'] + flags
+    proc = subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    proc.communicate()
+    if proc.returncode:
+        return None
+    binary = os.path.join(out, 'anduril.%s.sim' % name)
+    os.rename('anduril.%s.sim' % name, binary)
+    return binary
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
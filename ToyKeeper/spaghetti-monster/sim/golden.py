@@ -0,0 +1,185 @@
+#!/usr/bin/env python
+
+"""Checks each build target's outputs against its golden trace.
+
+Run it from the program's directory:
+
+    ../sim/golden.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the program for
+the simulator, runs every script in sim/golden/scripts/ (each one on a
+fresh light, with a blank eeprom), and records what the outputs do:
+PWM registers, enable pins, and aux LEDs.  Then it compares that to
+sim/golden/NAME.trace, and shows a diff for anything which changed.
+
+Options:
+    --update        write the new traces instead of comparing
+    --script F      run only this script  (can be repeated)
+    -D FOO          build with an extra flag  (or -UFOO;  can be repeated)
+
+A change in the trace isn't always a bug...  but it should always be on
+purpose.  If it is, run again with --update and commit the new traces
+along with the code.
+"""
+
+from __future__ import print_function
+
+import difflib
+import os
+import subprocess
+import sys
+
+SIM = os.path.dirname(os.path.abspath(__file__))
+GOLDEN = os.path.join(SIM, 'golden')
+DIFF_LINES = 40  # per target, so one bad change doesn't flood the screen
+
+
+def main(args):
+    """Build, run, and compare each target"""
+    update = False
+    scripts = []
+    flags = []
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--update':
+            update = True
+        elif arg == '--script':
+            scripts.append(os.path.abspath(args.pop(0)))
+        elif arg in ('-D', '-U'):
+            flags.append(arg + args.pop(0))
+        elif arg.startswith('-D') or arg.startswith('-U'):
+            flags.append(arg)
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+    if not scripts:
+        d = os.path.join(GOLDEN, 'scripts')
+        scripts = [os.path.join(d, f) for f in sorted(os.listdir(d))
+                   if f.endswith('.txt')]
+
+    out = 'golden-out'
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    passed = []
+    changed = []
+    new = []
+    skipped = []
+    for cfg in sorted(os.listdir('.')):
+        if not (cfg.startswith('cfg-') and cfg.endswith('.h')):
+            continue
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        binary = build(cfg, name, out, flags)
+        if not binary:
+            skipped.append(name)
+            continue
+
+        trace = {}
+        for script in scripts:
+            trace[os.path.basename(script)[:-4]] = simulate(binary, script)
+        path = os.path.join(GOLDEN, name + '.trace')
+        old = load_trace(path)
+
+        if update:
+            # keep sections for scripts which didn't run this time
+            old.update(trace)
+            save_trace(path, old)
+            print('%-28s updated' % name)
+            passed.append(name)
+        elif not old:
+            print('%-28s no golden trace' % name)
+            new.append(name)
+        else:
+            diff = []
+            for section in sorted(trace):
+                diff += difflib.unified_diff(
+                    old.get(section, []), trace[section],
+                    'golden/%s.trace  %s' % (name, section),
+                    '%s  %s' % (binary, section), lineterm='')
+            if diff:
+                print('%-28s CHANGED' % name)
+                for line in diff[:DIFF_LINES]:
+                    print('    ' + line)
+                if len(diff) > DIFF_LINES:
+                    print('    ... %i more lines' % (len(diff) - DIFF_LINES))
+                changed.append(name)
+            else:
+                print('%-28s ok' % name)
+                passed.append(name)
+        sys.stdout.flush()
+
+    print('')
+    print('Passed: %i  Changed: %s  No trace: %s  Skipped: %s' % (
+        len(passed), ' '.join(changed) or '-', ' '.join(new) or '-',
+        ' '.join(skipped) or '-'))
+    if changed or new:
+        return 1
+    return 0
+
+
+def build(cfg, name, out, flags):
+    """Build one target with the regular simulator driver"""
+    env = dict(os.environ)
+    env.pop('SIM_DRIVER', None)
+    cmd = [os.path.join(SIM, 'build.sh'), 'anduril', cfg] + flags
+    proc = subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    proc.communicate()
+    if proc.returncode:
+        return None
+    binary = os.path.join(out, 'anduril.%s.sim' % name)
+    os.rename('anduril.%s.sim' % name, binary)
+    return binary
+
+
+def simulate(binary, script):
+    """Run one script, and return the trace lines"""
+    proc = subprocess.Popen([binary, '-g', script], stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    text = proc.communicate()[0].decode('utf-8', 'replace')
+    lines = []
+    for line in text.splitlines():
+        # the summary has wall-clock time in it, which changes every run,
+        # and interrupt counts, which aren't visible outside the MCU
+        if line.startswith('#'):
+            if 'eeprom writes' in line:
+                lines.append('#' + line.split(',', 1)[1])
+            continue
+        lines.append(line)
+    if proc.returncode:
+        lines.append('exit status %i' % proc.returncode)
+    return lines
+
+
+def load_trace(path):
+    """Read a trace file into {script: [line, ...]}"""
+    trace = {}
+    if not os.path.exists(path):
+        return trace
+    section = None
+    for line in open(path):
+        line = line.rstrip('\n')
+        if line.startswith('== ') and line.endswith(' =='):
+            section = line[3:-3]
+            trace[section] = []
+        elif section is not None:
+            trace[section].append(line)
+    return trace
+
+
+def save_trace(path, trace):
+    f = open(path, 'w')
+    for section in sorted(trace):
+        f.write('== %s ==\n' % section)
+        for line in trace[section]:
+            f.write(line + '\n')
+    f.close()
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
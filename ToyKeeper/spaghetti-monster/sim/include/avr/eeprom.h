@@ -0,0 +1,70 @@
+/*
+ * avr/eeprom.h: Simulated eeprom, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_EEPROM_H
+#define SIM_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+
+// addresses are plain numbers cast to pointers, like on the AVR
+#define EEMEM
+#define SIM_EEP_ADDR(p) ((uint16_t)(uintptr_t)(p))
+
+#define eeprom_is_ready() 1
+#define eeprom_busy_wait() do {} while (0)
+
+static inline uint8_t eeprom_read_byte(const uint8_t *p) {
+    return sim_eeprom_read(SIM_EEP_ADDR(p));
+}
+static inline void eeprom_write_byte(uint8_t *p, uint8_t value) {
+    sim_eeprom_write(SIM_EEP_ADDR(p), value);
+}
+static inline void eeprom_update_byte(uint8_t *p, uint8_t value) {
+    if (eeprom_read_byte(p) != value) eeprom_write_byte(p, value);
+}
+static inline uint16_t eeprom_read_word(const uint16_t *p) {
+    const uint8_t *b = (const uint8_t *)p;
+    return eeprom_read_byte(b) | (eeprom_read_byte(b+1) << 8);
+}
+static inline void eeprom_write_word(uint16_t *p, uint16_t value) {
+    uint8_t *b = (uint8_t *)p;
+    eeprom_write_byte(b, value);
+    eeprom_write_byte(b+1, value >> 8);
+}
+static inline void eeprom_update_word(uint16_t *p, uint16_t value) {
+    uint8_t *b = (uint8_t *)p;
+    eeprom_update_byte(b, value);
+    eeprom_update_byte(b+1, value >> 8);
+}
+static inline void eeprom_read_block(void *dst, const void *src, size_t n) {
+    for (size_t i=0; i<n; i++)
+        ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+}
+static inline void eeprom_write_block(const void *src, void *dst, size_t n) {
+    for (size_t i=0; i<n; i++)
+        eeprom_write_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+static inline void eeprom_update_block(const void *src, void *dst, size_t n) {
+    for (size_t i=0; i<n; i++)
+        eeprom_update_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * avr/io-tiny1634.h: Simulated ATtiny1634 registers.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_IO_TINY1634_H
+#define SIM_AVR_IO_TINY1634_H
+
+#define E2END 0xFF
+#define RAMEND 0x4FF
+#define FLASHEND 0x3FFF
+
+// registers  (addresses are made up; only the names matter)
+#define ADCSRB  SIM_REG8(0x04)
+#define ADCSRA  SIM_REG8(0x06)
+#define ADMUX   SIM_REG8(0x07)
+#define ACSRB   SIM_REG8(0x08)
+#define ACSRA   SIM_REG8(0x09)
+#define PCMSK0  SIM_REG8(0x0A)
+#define PCMSK1  SIM_REG8(0x0B)
+#define PCMSK2  SIM_REG8(0x0C)
+#define PORTC   SIM_REG8(0x0D)
+#define DDRC    SIM_REG8(0x0E)
+#define PINC    SIM_PIN8(0x0F)
+#define PUEC    SIM_REG8(0x10)
+#define PORTB   SIM_REG8(0x11)
+#define DDRB    SIM_REG8(0x12)
+#define PINB    SIM_PIN8(0x13)
+#define PUEB    SIM_REG8(0x14)
+#define PORTA   SIM_REG8(0x15)
+#define DDRA    SIM_REG8(0x16)
+#define PINA    SIM_PIN8(0x17)
+#define PUEA    SIM_REG8(0x18)
+#define DIDR0   SIM_REG8(0x1A)
+#define DIDR1   SIM_REG8(0x1B)
+#define DIDR2   SIM_REG8(0x1C)
+#define EECR    SIM_REG8(0x1E)
+#define EEDR    SIM_REG8(0x1F)
+#define EEARL   SIM_REG8(0x20)
+#define EEARH   SIM_REG8(0x21)
+#define GIFR    SIM_REG8(0x23)
+#define GIMSK   SIM_REG8(0x24)
+#define TCCR0A  SIM_REG8(0x25)
+#define TCCR0B  SIM_REG8(0x26)
+#define TCNT0   SIM_REG8(0x27)
+#define OCR0A   SIM_REG8(0x28)
+#define OCR0B   SIM_REG8(0x29)
+#define TIFR    SIM_REG8(0x2A)
+#define TIMSK   SIM_REG8(0x2B)
+#define TCCR1A  SIM_REG8(0x2C)
+#define TCCR1B  SIM_REG8(0x2D)
+#define TCCR1C  SIM_REG8(0x2E)
+#define PRR     SIM_REG8(0x32)
+#define CLKPR   SIM_REG8(0x33)
+#define CLKSR   SIM_REG8(0x34)
+#define MCUSR   SIM_REG8(0x35)
+#define MCUCR   SIM_REG8(0x36)
+#define CCP     SIM_REG8(0x37)
+#define WDTCSR  SIM_REG8(0x38)
+#define SPL     SIM_REG8(0x3D)
+#define ADC     SIM_REG16(0x40)
+#define ADCW    SIM_REG16(0x40)
+#define TCNT1   SIM_REG16(0x42)
+#define OCR1A   SIM_REG16(0x44)
+#define OCR1B   SIM_REG16(0x46)
+#define ICR1    SIM_REG16(0x48)
+#define ADCL    SIM_REG8(0x40)
+#define ADCH    SIM_REG8(0x41)
+#define TCNT1L  SIM_REG8(0x42)
+#define TCNT1H  SIM_REG8(0x43)
+#define OCR1AL  SIM_REG8(0x44)
+#define OCR1AH  SIM_REG8(0x45)
+#define OCR1BL  SIM_REG8(0x46)
+#define OCR1BH  SIM_REG8(0x47)
+#define ICR1L   SIM_REG8(0x48)
+#define ICR1H   SIM_REG8(0x49)
+
+// ADCSRB
+#define VDEN    7
+#define VDPD    6
+#define ADLAR   3
+#define ADTS2   2
+#define ADTS1   1
+#define ADTS0   0
+// ADCSRA
+#define ADEN    7
+#define ADSC    6
+#define ADATE   5
+#define ADIF    4
+#define ADIE    3
+#define ADPS2   2
+#define ADPS1   1
+#define ADPS0   0
+// ADMUX
+#define REFS1   7
+#define REFS0   6
+#define REFEN   5
+#define ADC0EN  4
+#define MUX3    3
+#define MUX2    2
+#define MUX1    1
+#define MUX0    0
+// ACSRA
+#define ACD     7
+// DIDR0
+#define ADC4D   7
+#define ADC3D   6
+#define ADC2D   5
+#define ADC1D   4
+#define ADC0D   3
+#define AIN1D   2
+#define AIN0D   1
+#define AREFD   0
+// DIDR1
+#define ADC8D   3
+#define ADC7D   2
+#define ADC6D   1
+#define ADC5D   0
+// DIDR2
+#define ADC11D  2
+#define ADC10D  1
+#define ADC9D   0
+// PCMSK0
+#define PCINT7  7
+#define PCINT6  6
+#define PCINT5  5
+#define PCINT4  4
+#define PCINT3  3
+#define PCINT2  2
+#define PCINT1  1
+#define PCINT0  0
+// PCMSK1
+#define PCINT11 3
+#define PCINT10 2
+#define PCINT9  1
+#define PCINT8  0
+// PCMSK2
+#define PCINT17 5
+#define PCINT16 4
+#define PCINT15 3
+#define PCINT14 2
+#define PCINT13 1
+#define PCINT12 0
+// port A
+#define PA7     7
+#define PA6     6
+#define PA5     5
+#define PA4     4
+#define PA3     3
+#define PA2     2
+#define PA1     1
+#define PA0     0
+// port B
+#define PB3     3
+#define PB2     2
+#define PB1     1
+#define PB0     0
+// port C
+#define PC5     5
+#define PC4     4
+#define PC3     3
+#define PC2     2
+#define PC1     1
+#define PC0     0
+// GIMSK / GIFR
+#define INT0    6
+#define PCIE2   5
+#define PCIE1   4
+#define PCIE0   3
+#define INTF0   6
+#define PCIF2   5
+#define PCIF1   4
+#define PCIF0   3
+// TCCR0A
+#define COM0A1  7
+#define COM0A0  6
+#define COM0B1  5
+#define COM0B0  4
+#define WGM01   1
+#define WGM00   0
+// TCCR0B
+#define FOC0A   7
+#define FOC0B   6
+#define WGM02   3
+#define CS02    2
+#define CS01    1
+#define CS00    0
+// TCCR1A
+#define COM1A1  7
+#define COM1A0  6
+#define COM1B1  5
+#define COM1B0  4
+#define WGM11   1
+#define WGM10   0
+// TCCR1B
+#define ICNC1   7
+#define ICES1   6
+#define WGM13   4
+#define WGM12   3
+#define CS12    2
+#define CS11    1
+#define CS10    0
+// TIMSK / TIFR
+#define TOIE1   7
+#define OCIE1A  6
+#define OCIE1B  5
+#define ICIE1   3
+#define OCIE0B  2
+#define TOIE0   1
+#define OCIE0A  0
+#define TOV1    7
+#define OCF1A   6
+#define OCF1B   5
+#define ICF1    3
+#define OCF0B   2
+#define TOV0    1
+#define OCF0A   0
+// PRR
+#define PRTWI   6
+#define PRTIM1  5
+#define PRTIM0  4
+#define PRUSI   3
+#define PRUSART1 2
+#define PRUSART0 1
+#define PRADC   0
+// CLKPR
+#define CLKPS3  3
+#define CLKPS2  2
+#define CLKPS1  1
+#define CLKPS0  0
+// MCUSR
+#define WDRF    3
+#define BORF    2
+#define EXTRF   1
+#define PORF    0
+// MCUCR
+#define SM1     6
+#define SM0     5
+#define SE      4
+#define ISC01   1
+#define ISC00   0
+// WDTCSR
+#define WDIF    7
+#define WDIE    6
+#define WDP3    5
+#define WDE     3
+#define WDP2    2
+#define WDP1    1
+#define WDP0    0
+
+// interrupt vectors
+#define INT0_vect           sim_vect_INT0
+#define PCINT0_vect         sim_vect_PCINT0
+#define PCINT1_vect         sim_vect_PCINT1
+#define PCINT2_vect         sim_vect_PCINT2
+#define WDT_vect            sim_vect_WDT
+#define TIMER1_CAPT_vect    sim_vect_TIMER1_CAPT
+#define TIMER1_COMPA_vect   sim_vect_TIMER1_COMPA
+#define TIMER1_COMPB_vect   sim_vect_TIMER1_COMPB
+#define TIMER1_OVF_vect     sim_vect_TIMER1_OVF
+#define TIMER0_COMPA_vect   sim_vect_TIMER0_COMPA
+#define TIMER0_COMPB_vect   sim_vect_TIMER0_COMPB
+#define TIMER0_OVF_vect     sim_vect_TIMER0_OVF
+#define ANA_COMP_vect       sim_vect_ANA_COMP
+#define ADC_vect            sim_vect_ADC
+#define EE_RDY_vect         sim_vect_EE_RDY
+#define ADC_READY_vect      sim_vect_ADC
+SIM_VECTOR(sim_vect_INT0);
+SIM_VECTOR(sim_vect_PCINT0);
+SIM_VECTOR(sim_vect_PCINT1);
+SIM_VECTOR(sim_vect_PCINT2);
+SIM_VECTOR(sim_vect_WDT);
+SIM_VECTOR(sim_vect_TIMER1_CAPT);
+SIM_VECTOR(sim_vect_TIMER1_COMPA);
+SIM_VECTOR(sim_vect_TIMER1_COMPB);
+SIM_VECTOR(sim_vect_TIMER1_OVF);
+SIM_VECTOR(sim_vect_TIMER0_COMPA);
+SIM_VECTOR(sim_vect_TIMER0_COMPB);
+SIM_VECTOR(sim_vect_TIMER0_OVF);
+SIM_VECTOR(sim_vect_ANA_COMP);
+SIM_VECTOR(sim_vect_ADC);
+SIM_VECTOR(sim_vect_EE_RDY);
+
+#endif
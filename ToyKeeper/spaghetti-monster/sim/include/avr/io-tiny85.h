@@ -0,0 +1,255 @@
+/*
+ * avr/io-tiny85.h: Simulated ATtiny25/45/85 registers.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_IO_TINY85_H
+#define SIM_AVR_IO_TINY85_H
+
+// sizes
+#if (ATTINY == 25)
+#define E2END 0x7F
+#define RAMEND 0xDF
+#define FLASHEND 0x7FF
+#elif (ATTINY == 45)
+#define E2END 0xFF
+#define RAMEND 0x15F
+#define FLASHEND 0xFFF
+#else
+#define E2END 0x1FF
+#define RAMEND 0x25F
+#define FLASHEND 0x1FFF
+#endif
+
+// registers, at their real I/O addresses
+#define ADCSRB  SIM_REG8(0x03)
+#define ADC     SIM_REG16(0x04)
+#define ADCW    SIM_REG16(0x04)
+#define ADCL    SIM_REG8(0x04)
+#define ADCH    SIM_REG8(0x05)
+#define ADCSRA  SIM_REG8(0x06)
+#define ADMUX   SIM_REG8(0x07)
+#define ACSR    SIM_REG8(0x08)
+#define DIDR0   SIM_REG8(0x14)
+#define PCMSK   SIM_REG8(0x15)
+#define PINB    SIM_PIN8(0x16)
+#define DDRB    SIM_REG8(0x17)
+#define PORTB   SIM_REG8(0x18)
+#define EECR    SIM_REG8(0x1C)
+#define EEDR    SIM_REG8(0x1D)
+#define EEARL   SIM_REG8(0x1E)
+#define EEARH   SIM_REG8(0x1F)
+#define PRR     SIM_REG8(0x20)
+#define WDTCR   SIM_REG8(0x21)
+#define CLKPR   SIM_REG8(0x26)
+#define OCR0B   SIM_REG8(0x28)
+#define OCR0A   SIM_REG8(0x29)
+#define TCCR0A  SIM_REG8(0x2A)
+#define OCR1B   SIM_REG8(0x2B)
+#define GTCCR   SIM_REG8(0x2C)
+#define OCR1C   SIM_REG8(0x2D)
+#define OCR1A   SIM_REG8(0x2E)
+#define TCNT1   SIM_REG8(0x2F)
+#define TCCR1   SIM_REG8(0x30)
+#define OSCCAL  SIM_REG8(0x31)
+#define TCNT0   SIM_REG8(0x32)
+#define TCCR0B  SIM_REG8(0x33)
+#define MCUSR   SIM_REG8(0x34)
+#define MCUCR   SIM_REG8(0x35)
+#define TIFR    SIM_REG8(0x38)
+#define TIMSK   SIM_REG8(0x39)
+#define GIFR    SIM_REG8(0x3A)
+#define GIMSK   SIM_REG8(0x3B)
+
+// ADCSRB
+#define BIN     7
+#define ACME    6
+#define IPR     5
+#define ADTS2   2
+#define ADTS1   1
+#define ADTS0   0
+// ADCSRA
+#define ADEN    7
+#define ADSC    6
+#define ADATE   5
+#define ADIF    4
+#define ADIE    3
+#define ADPS2   2
+#define ADPS1   1
+#define ADPS0   0
+// ADMUX
+#define REFS1   7
+#define REFS0   6
+#define ADLAR   5
+#define REFS2   4
+#define MUX3    3
+#define MUX2    2
+#define MUX1    1
+#define MUX0    0
+// ACSR
+#define ACD     7
+// DIDR0
+#define ADC0D   5
+#define ADC2D   4
+#define ADC3D   3
+#define ADC1D   2
+#define AIN1D   1
+#define AIN0D   0
+// PCMSK
+#define PCINT5  5
+#define PCINT4  4
+#define PCINT3  3
+#define PCINT2  2
+#define PCINT1  1
+#define PCINT0  0
+// port B
+#define PB5     5
+#define PB4     4
+#define PB3     3
+#define PB2     2
+#define PB1     1
+#define PB0     0
+#define PINB5   5
+#define PINB4   4
+#define PINB3   3
+#define PINB2   2
+#define PINB1   1
+#define PINB0   0
+#define DDB5    5
+#define DDB4    4
+#define DDB3    3
+#define DDB2    2
+#define DDB1    1
+#define DDB0    0
+#define PORTB5  5
+#define PORTB4  4
+#define PORTB3  3
+#define PORTB2  2
+#define PORTB1  1
+#define PORTB0  0
+// PRR
+#define PRTIM1  3
+#define PRTIM0  2
+#define PRUSI   1
+#define PRADC   0
+// WDTCR
+#define WDIF    7
+#define WDIE    6
+#define WDP3    5
+#define WDCE    4
+#define WDE     3
+#define WDP2    2
+#define WDP1    1
+#define WDP0    0
+// CLKPR
+#define CLKPCE  7
+#define CLKPS3  3
+#define CLKPS2  2
+#define CLKPS1  1
+#define CLKPS0  0
+// TCCR0A
+#define COM0A1  7
+#define COM0A0  6
+#define COM0B1  5
+#define COM0B0  4
+#define WGM01   1
+#define WGM00   0
+// TCCR0B
+#define FOC0A   7
+#define FOC0B   6
+#define WGM02   3
+#define CS02    2
+#define CS01    1
+#define CS00    0
+// TCCR1
+#define CTC1    7
+#define PWM1A   6
+#define COM1A1  5
+#define COM1A0  4
+#define CS13    3
+#define CS12    2
+#define CS11    1
+#define CS10    0
+// GTCCR
+#define TSM     7
+#define PWM1B   6
+#define COM1B1  5
+#define COM1B0  4
+#define FOC1B   3
+#define FOC1A   2
+#define PSR1    1
+#define PSR0    0
+// MCUSR
+#define WDRF    3
+#define BORF    2
+#define EXTRF   1
+#define PORF    0
+// MCUCR
+#define BODS    7
+#define PUD     6
+#define SE      5
+#define SM1     4
+#define SM0     3
+#define BODSE   2
+#define ISC01   1
+#define ISC00   0
+// TIMSK / TIFR
+#define OCIE1A  6
+#define OCIE1B  5
+#define OCIE0A  4
+#define OCIE0B  3
+#define TOIE1   2
+#define TOIE0   1
+#define OCF1A   6
+#define OCF1B   5
+#define OCF0A   4
+#define OCF0B   3
+#define TOV1    2
+#define TOV0    1
+// GIMSK / GIFR
+#define INT0    6
+#define PCIE    5
+#define INTF0   6
+#define PCIF    5
+
+// interrupt vectors
+#define INT0_vect           sim_vect_INT0
+#define PCINT0_vect         sim_vect_PCINT0
+#define TIMER1_COMPA_vect   sim_vect_TIMER1_COMPA
+#define TIMER1_OVF_vect     sim_vect_TIMER1_OVF
+#define TIMER0_OVF_vect     sim_vect_TIMER0_OVF
+#define EE_RDY_vect         sim_vect_EE_RDY
+#define ANA_COMP_vect       sim_vect_ANA_COMP
+#define ADC_vect            sim_vect_ADC
+#define TIMER1_COMPB_vect   sim_vect_TIMER1_COMPB
+#define TIMER0_COMPA_vect   sim_vect_TIMER0_COMPA
+#define TIMER0_COMPB_vect   sim_vect_TIMER0_COMPB
+#define WDT_vect            sim_vect_WDT
+SIM_VECTOR(sim_vect_INT0);
+SIM_VECTOR(sim_vect_PCINT0);
+SIM_VECTOR(sim_vect_TIMER1_COMPA);
+SIM_VECTOR(sim_vect_TIMER1_OVF);
+SIM_VECTOR(sim_vect_TIMER0_OVF);
+SIM_VECTOR(sim_vect_EE_RDY);
+SIM_VECTOR(sim_vect_ANA_COMP);
+SIM_VECTOR(sim_vect_ADC);
+SIM_VECTOR(sim_vect_TIMER1_COMPB);
+SIM_VECTOR(sim_vect_TIMER0_COMPA);
+SIM_VECTOR(sim_vect_TIMER0_COMPB);
+SIM_VECTOR(sim_vect_WDT);
+
+#endif
@@ -0,0 +1,351 @@
+/*
+ * avr/io-xmega3.h: Simulated tinyAVR 1-series registers (tiny1616 etc).
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_IO_XMEGA3_H
+#define SIM_AVR_IO_XMEGA3_H
+
+// sizes  (for the 16 KiB parts)
+#define E2END 0xFF
+#define RAMEND 0x3FFF
+#define FLASHEND 0x3FFF
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+// peripherals are structs, like the real headers, but with only the
+// fields FSM and the hwdef files use  (plus padding where the layout
+// matters, like PORT_t.PINnCTRL)
+
+typedef struct PORT_struct {
+    register8_t DIR, DIRSET, DIRCLR, DIRTGL;
+    register8_t OUT, OUTSET, OUTCLR, OUTTGL;
+    register8_t IN, INTFLAGS, PORTCTRL;
+    register8_t reserved[5];
+    register8_t PIN0CTRL, PIN1CTRL, PIN2CTRL, PIN3CTRL;
+    register8_t PIN4CTRL, PIN5CTRL, PIN6CTRL, PIN7CTRL;
+} PORT_t;
+
+typedef struct VPORT_struct {
+    register8_t DIR, OUT, IN, INTFLAGS;
+} VPORT_t;
+
+typedef struct ADC_struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLE, SAMPCTRL, MUXPOS;
+    register8_t COMMAND, EVCTRL, INTCTRL, INTFLAGS, DBGCTRL, TEMP;
+    union {
+        register16_t RES;
+        struct { register8_t RESL, RESH; };
+    };
+} ADC_t;
+
+typedef struct RTC_struct {
+    register8_t CTRLA, STATUS, INTCTRL, INTFLAGS, CLKSEL;
+    register8_t PITCTRLA, PITSTATUS, PITINTCTRL, PITINTFLAGS;
+} RTC_t;
+
+typedef struct TCA_SINGLE_struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLECLR, CTRLESET;
+    register8_t INTCTRL, INTFLAGS;
+    register16_t CNT, PER, CMP0, CMP1, CMP2;
+    register16_t PERBUF, CMP0BUF, CMP1BUF, CMP2BUF;
+} TCA_SINGLE_t;
+
+typedef struct TCA_struct {
+    TCA_SINGLE_t SINGLE;
+} TCA_t;
+
+typedef struct CLKCTRL_struct {
+    register8_t MCLKCTRLA, MCLKCTRLB, MCLKLOCK, MCLKSTATUS;
+} CLKCTRL_t;
+
+typedef struct RSTCTRL_struct {
+    register8_t RSTFR, SWRR;
+} RSTCTRL_t;
+
+typedef struct WDT_struct {
+    register8_t CTRLA, STATUS;
+} WDT_t;
+
+typedef struct VREF_struct {
+    register8_t CTRLA, CTRLB;
+} VREF_t;
+
+typedef struct DAC_struct {
+    register8_t CTRLA, DATA;
+} DAC_t;
+
+typedef struct SIGROW_struct {
+    register8_t TEMPSENSE0, TEMPSENSE1;
+} SIGROW_t;
+
+typedef struct PORTMUX_struct {
+    register8_t CTRLA, CTRLB, CTRLC, CTRLD;
+} PORTMUX_t;
+
+extern PORT_t sim_PORT[3];
+extern VPORT_t sim_VPORT[3];
+extern ADC_t sim_ADC0;
+extern RTC_t sim_RTC;
+extern TCA_t sim_TCA0;
+extern CLKCTRL_t sim_CLKCTRL;
+extern RSTCTRL_t sim_RSTCTRL;
+extern WDT_t sim_WDT;
+extern VREF_t sim_VREF;
+extern DAC_t sim_DAC0;
+extern SIGROW_t sim_SIGROW;
+extern PORTMUX_t sim_PORTMUX;
+
+#define PORTA    (sim_PORT[0])
+#define PORTB    (sim_PORT[1])
+#define PORTC    (sim_PORT[2])
+// (read through a function, so pin polling loops let time pass)
+VPORT_t *sim_vport(uint8_t n);
+#define VPORTA   (*sim_vport(0))
+#define VPORTB   (*sim_vport(1))
+#define VPORTC   (*sim_vport(2))
+#define PORTA_OUT (PORTA.OUT)
+#define PORTB_OUT (PORTB.OUT)
+#define PORTC_OUT (PORTC.OUT)
+#define ADC0     sim_ADC0
+#define RTC      sim_RTC
+#define TCA0     sim_TCA0
+#define CLKCTRL  sim_CLKCTRL
+#define RSTCTRL  sim_RSTCTRL
+#define WDT      sim_WDT
+#define VREF     sim_VREF
+#define DAC0     sim_DAC0
+#define SIGROW   sim_SIGROW
+#define PORTMUX  sim_PORTMUX
+#define CCP      SIM_REG8(0x34)
+
+// CPU
+#define CCP_SPM_gc    (0x9D)
+#define CCP_IOREG_gc  (0xD8)
+// (from avr/xmega.h)
+#define _PROTECTED_WRITE(reg, value) do { CCP = CCP_IOREG_gc; (reg) = (value); } while (0)
+
+// fuses  (from avr/fuse.h; they go nowhere on the host)
+typedef struct NVM_FUSES_struct {
+    uint8_t WDTCFG, BODCFG, OSCCFG, reserved_1, TCD0CFG, SYSCFG0, SYSCFG1;
+    uint8_t APPEND, BOOTEND;
+} NVM_FUSES_t;
+#define FUSES NVM_FUSES_t __fuse
+#define FUSE_WDTCFG_DEFAULT   (0x00)
+#define FUSE_BODCFG_DEFAULT   (0x00)
+#define FUSE_OSCCFG_DEFAULT   (0x02)
+#define FUSE_TCD0CFG_DEFAULT  (0x00)
+#define FUSE_SYSCFG0_DEFAULT  (0xF6)
+#define FUSE_SYSCFG1_DEFAULT  (0xFF)
+#define FUSE_APPEND_DEFAULT   (0x00)
+#define FUSE_BOOTEND_DEFAULT  (0x00)
+#define FUSE_ACTIVE0_bm       (0x04)
+#define FUSE_ACTIVE1_bm       (0x08)
+
+// PORT
+#define PIN0_bm 0x01
+#define PIN1_bm 0x02
+#define PIN2_bm 0x04
+#define PIN3_bm 0x08
+#define PIN4_bm 0x10
+#define PIN5_bm 0x20
+#define PIN6_bm 0x40
+#define PIN7_bm 0x80
+#define PIN0_bp 0
+#define PIN1_bp 1
+#define PIN2_bp 2
+#define PIN3_bp 3
+#define PIN4_bp 4
+#define PIN5_bp 5
+#define PIN6_bp 6
+#define PIN7_bp 7
+#define PORT_ISC_gm                (0x07)
+#define PORT_ISC_INTDISABLE_gc     (0x00)
+#define PORT_ISC_BOTHEDGES_gc      (0x01)
+#define PORT_ISC_RISING_gc         (0x02)
+#define PORT_ISC_FALLING_gc        (0x03)
+#define PORT_ISC_INPUT_DISABLE_gc  (0x04)
+#define PORT_ISC_LEVEL_gc          (0x05)
+#define PORT_PULLUPEN_bm           (0x08)
+#define PORT_INVEN_bm              (0x80)
+#define PORTMUX_TCA00_ALTERNATE_gc (0x01)
+#define PORTMUX_TCA01_ALTERNATE_gc (0x02)
+#define PORTMUX_TCA02_ALTERNATE_gc (0x04)
+
+// ADC
+#define ADC_ENABLE_bm          (0x01)
+#define ADC_FREERUN_bm         (0x02)
+#define ADC_RESSEL_bm          (0x04)
+#define ADC_RUNSTBY_bm         (0x80)
+#define ADC_STCONV_bm          (0x01)
+#define ADC_RESRDY_bm          (0x01)
+#define ADC_WCMP_bm            (0x02)
+#define ADC_SAMPCAP_bm         (0x40)
+#define ADC_PRESC_gm           (0x07)
+#define ADC_PRESC_DIV2_gc      (0x00)
+#define ADC_PRESC_DIV4_gc      (0x01)
+#define ADC_PRESC_DIV8_gc      (0x02)
+#define ADC_PRESC_DIV16_gc     (0x03)
+#define ADC_PRESC_DIV32_gc     (0x04)
+#define ADC_PRESC_DIV64_gc     (0x05)
+#define ADC_PRESC_DIV128_gc    (0x06)
+#define ADC_PRESC_DIV256_gc    (0x07)
+#define ADC_REFSEL_gm          (0x30)
+#define ADC_REFSEL_INTREF_gc   (0x00<<4)
+#define ADC_REFSEL_VDDREF_gc   (0x01<<4)
+#define ADC_REFSEL_VREFA_gc    (0x02<<4)
+#define ADC_MUXPOS_AIN0_gc     (0x00)
+#define ADC_MUXPOS_AIN1_gc     (0x01)
+#define ADC_MUXPOS_AIN2_gc     (0x02)
+#define ADC_MUXPOS_AIN3_gc     (0x03)
+#define ADC_MUXPOS_AIN4_gc     (0x04)
+#define ADC_MUXPOS_AIN5_gc     (0x05)
+#define ADC_MUXPOS_AIN6_gc     (0x06)
+#define ADC_MUXPOS_AIN7_gc     (0x07)
+#define ADC_MUXPOS_AIN8_gc     (0x08)
+#define ADC_MUXPOS_AIN9_gc     (0x09)
+#define ADC_MUXPOS_AIN10_gc    (0x0A)
+#define ADC_MUXPOS_AIN11_gc    (0x0B)
+#define ADC_MUXPOS_DAC0_gc     (0x1C)
+#define ADC_MUXPOS_INTREF_gc   (0x1D)
+#define ADC_MUXPOS_TEMPSENSE_gc (0x1E)
+#define ADC_MUXPOS_GND_gc      (0x1F)
+
+// RTC
+#define RTC_PITEN_bm           (0x01)
+#define RTC_PI_bm              (0x01)
+#define RTC_CTRLBUSY_bm        (0x01)
+#define RTC_PERIOD_gm          (0x78)
+#define RTC_PERIOD_OFF_gc      (0x00<<3)
+#define RTC_PERIOD_CYC4_gc     (0x01<<3)
+#define RTC_PERIOD_CYC8_gc     (0x02<<3)
+#define RTC_PERIOD_CYC16_gc    (0x03<<3)
+#define RTC_PERIOD_CYC32_gc    (0x04<<3)
+#define RTC_PERIOD_CYC64_gc    (0x05<<3)
+#define RTC_PERIOD_CYC128_gc   (0x06<<3)
+#define RTC_PERIOD_CYC256_gc   (0x07<<3)
+#define RTC_PERIOD_CYC512_gc   (0x08<<3)
+#define RTC_PERIOD_CYC1024_gc  (0x09<<3)
+#define RTC_PERIOD_CYC2048_gc  (0x0A<<3)
+#define RTC_PERIOD_CYC4096_gc  (0x0B<<3)
+#define RTC_PERIOD_CYC8192_gc  (0x0C<<3)
+#define RTC_PERIOD_CYC16384_gc (0x0D<<3)
+#define RTC_PERIOD_CYC32768_gc (0x0E<<3)
+
+// TCA
+#define TCA_SINGLE_ENABLE_bm   (0x01)
+#define TCA_SINGLE_CLKSEL_gm   (0x0E)
+#define TCA_SINGLE_CLKSEL_DIV1_gc    (0x00<<1)
+#define TCA_SINGLE_CLKSEL_DIV2_gc    (0x01<<1)
+#define TCA_SINGLE_CLKSEL_DIV4_gc    (0x02<<1)
+#define TCA_SINGLE_CLKSEL_DIV8_gc    (0x03<<1)
+#define TCA_SINGLE_CLKSEL_DIV16_gc   (0x04<<1)
+#define TCA_SINGLE_CLKSEL_DIV64_gc   (0x05<<1)
+#define TCA_SINGLE_CLKSEL_DIV256_gc  (0x06<<1)
+#define TCA_SINGLE_CLKSEL_DIV1024_gc (0x07<<1)
+#define TCA_SINGLE_CMP0EN_bm   (0x10)
+#define TCA_SINGLE_CMP1EN_bm   (0x20)
+#define TCA_SINGLE_CMP2EN_bm   (0x40)
+#define TCA_SINGLE_ALUPD_bm    (0x08)
+#define TCA_SINGLE_WGMODE_gm   (0x07)
+#define TCA_SINGLE_WGMODE_NORMAL_gc      (0x00)
+#define TCA_SINGLE_WGMODE_FRQ_gc         (0x01)
+#define TCA_SINGLE_WGMODE_SINGLESLOPE_gc (0x03)
+#define TCA_SINGLE_WGMODE_DSTOP_gc       (0x05)
+#define TCA_SINGLE_WGMODE_DSBOTH_gc      (0x06)
+#define TCA_SINGLE_WGMODE_DSBOTTOM_gc    (0x07)
+
+// CLKCTRL
+#define CLKCTRL_PEN_bm         (0x01)
+#define CLKCTRL_PDIV_gm        (0x1E)
+#define CLKCTRL_PDIV_2X_gc     (0x00<<1)
+#define CLKCTRL_PDIV_4X_gc     (0x01<<1)
+#define CLKCTRL_PDIV_8X_gc     (0x02<<1)
+#define CLKCTRL_PDIV_16X_gc    (0x03<<1)
+#define CLKCTRL_PDIV_32X_gc    (0x04<<1)
+#define CLKCTRL_PDIV_64X_gc    (0x05<<1)
+#define CLKCTRL_PDIV_6X_gc     (0x08<<1)
+#define CLKCTRL_PDIV_10X_gc    (0x09<<1)
+#define CLKCTRL_PDIV_12X_gc    (0x0A<<1)
+#define CLKCTRL_PDIV_24X_gc    (0x0B<<1)
+#define CLKCTRL_PDIV_48X_gc    (0x0C<<1)
+#define CLKCTRL_SOSC_bm        (0x01)
+
+// RSTCTRL
+#define RSTCTRL_PORF_bm        (0x01)
+#define RSTCTRL_BORF_bm        (0x02)
+#define RSTCTRL_EXTRF_bm       (0x04)
+#define RSTCTRL_WDRF_bm        (0x08)
+#define RSTCTRL_SWRF_bm        (0x10)
+#define RSTCTRL_UPDIRF_bm      (0x20)
+#define RSTCTRL_SWRE_bm        (0x01)
+
+// WDT
+#define WDT_PERIOD_gm          (0x0F)
+#define WDT_PERIOD_OFF_gc      (0x00)
+#define WDT_PERIOD_8CLK_gc     (0x01)
+#define WDT_PERIOD_16CLK_gc    (0x02)
+#define WDT_PERIOD_32CLK_gc    (0x03)
+#define WDT_PERIOD_64CLK_gc    (0x04)
+
+// VREF
+#define VREF_DAC0REFSEL_gm     (0x07)
+#define VREF_DAC0REFSEL_0V55_gc (0x00)
+#define VREF_DAC0REFSEL_1V1_gc  (0x01)
+#define VREF_DAC0REFSEL_2V5_gc  (0x02)
+#define VREF_DAC0REFSEL_4V34_gc (0x03)
+#define VREF_DAC0REFSEL_1V5_gc  (0x04)
+#define VREF_ADC0REFSEL_gm     (0x70)
+#define VREF_ADC0REFSEL_0V55_gc (0x00<<4)
+#define VREF_ADC0REFSEL_1V1_gc  (0x01<<4)
+#define VREF_ADC0REFSEL_2V5_gc  (0x02<<4)
+#define VREF_ADC0REFSEL_4V34_gc (0x03<<4)
+#define VREF_ADC0REFSEL_1V5_gc  (0x04<<4)
+#define VREF_DAC0REFEN_bm      (0x01)
+#define VREF_ADC0REFEN_bm      (0x02)
+
+// DAC
+#define DAC_ENABLE_bm          (0x01)
+#define DAC_OUTEN_bm           (0x40)
+#define DAC_RUNSTDBY_bm        (0x80)
+
+// interrupt vectors
+#define RTC_CNT_vect        sim_vect_RTC_CNT
+#define RTC_PIT_vect        sim_vect_RTC_PIT
+#define ADC0_RESRDY_vect    sim_vect_ADC0_RESRDY
+#define ADC0_WCOMP_vect     sim_vect_ADC0_WCOMP
+#define PORTA_PORT_vect     sim_vect_PORTA_PORT
+#define PORTB_PORT_vect     sim_vect_PORTB_PORT
+#define PORTC_PORT_vect     sim_vect_PORTC_PORT
+#define TCA0_OVF_vect       sim_vect_TCA0_OVF
+#define TCA0_CMP0_vect      sim_vect_TCA0_CMP0
+#define TCA0_CMP1_vect      sim_vect_TCA0_CMP1
+#define TCA0_CMP2_vect      sim_vect_TCA0_CMP2
+SIM_VECTOR(sim_vect_RTC_CNT);
+SIM_VECTOR(sim_vect_RTC_PIT);
+SIM_VECTOR(sim_vect_ADC0_RESRDY);
+SIM_VECTOR(sim_vect_ADC0_WCOMP);
+SIM_VECTOR(sim_vect_PORTA_PORT);
+SIM_VECTOR(sim_vect_PORTB_PORT);
+SIM_VECTOR(sim_vect_PORTC_PORT);
+SIM_VECTOR(sim_vect_TCA0_OVF);
+SIM_VECTOR(sim_vect_TCA0_CMP0);
+SIM_VECTOR(sim_vect_TCA0_CMP1);
+SIM_VECTOR(sim_vect_TCA0_CMP2);
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * avr/io.h: Simulated AVR registers, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+#include "sim-hal.h"
+
+// interrupt vectors are plain functions, which sim.c calls if they exist
+#define SIM_VECTOR(name) extern void name(void) __attribute__ ((weak))
+
+#define _BV(bit) (1 << (bit))
+#define bit_is_set(sfr, bit) ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (! ((sfr) & _BV(bit)))
+
+// (the real headers go by -mmcu, but host builds only have ATTINY)
+#if (ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85)
+#include "avr/io-tiny85.h"
+#elif (ATTINY == 1634)
+#include "avr/io-tiny1634.h"
+#elif (ATTINY == 412) || (ATTINY == 416) || (ATTINY == 417) || (ATTINY == 816) || (ATTINY == 817) || (ATTINY == 1616) || (ATTINY == 1617) || (ATTINY == 3216) || (ATTINY == 3217)
+#include "avr/io-xmega3.h"
+#else
+#error The simulator does not support this MCU.
+#endif
+
+#define SREG SIM_REG8(SIM_SREG)
+
+#endif
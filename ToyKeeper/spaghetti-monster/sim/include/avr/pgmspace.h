@@ -0,0 +1,43 @@
+/*
+ * avr/pgmspace.h: Program memory access, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_PGMSPACE_H
+#define SIM_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// on the host, "flash" is just regular read-only memory...
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+// ... except when code reads a raw flash address, like pseudo_rand() does
+// (host pointers are never that low, in a non-PIE build)
+uint8_t sim_flash_byte(uint16_t addr);
+#define pgm_read_byte(addr) \
+    (((uintptr_t)(addr) <= 0xffff) ? sim_flash_byte((uintptr_t)(addr)) \
+                                     : *(const uint8_t *)(uintptr_t)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_byte_near pgm_read_byte
+#define pgm_read_word_near pgm_read_word
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * avr/power.h: Simulated clock prescaler, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_POWER_H
+#define SIM_AVR_POWER_H
+
+#include <avr/io.h>
+
+// (tk-attiny.h has its own versions for the 1634 and 1-series)
+#if (ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85)
+typedef enum {
+    clock_div_1 = 0,
+    clock_div_2 = 1,
+    clock_div_4 = 2,
+    clock_div_8 = 3,
+    clock_div_16 = 4,
+    clock_div_32 = 5,
+    clock_div_64 = 6,
+    clock_div_128 = 7,
+    clock_div_256 = 8
+} clock_div_t;
+
+static inline void clock_prescale_set(clock_div_t n) {
+    CLKPR = (1 << CLKPCE);
+    CLKPR = n;
+}
+#define clock_prescale_get() ((clock_div_t)(CLKPR & 0x0F))
+
+#define power_adc_enable()   (PRR &= ~(1 << PRADC))
+#define power_adc_disable()  (PRR |= (1 << PRADC))
+#define power_timer0_enable()  (PRR &= ~(1 << PRTIM0))
+#define power_timer0_disable() (PRR |= (1 << PRTIM0))
+#define power_timer1_enable()  (PRR &= ~(1 << PRTIM1))
+#define power_timer1_disable() (PRR |= (1 << PRTIM1))
+#endif
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * avr/sleep.h: Simulated sleep modes, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_AVR_SLEEP_H
+#define SIM_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE      0
+#define SLEEP_MODE_ADC       1
+#define SLEEP_MODE_PWR_DOWN  2
+#define SLEEP_MODE_STANDBY   3
+
+#define set_sleep_mode(mode) (sim_sleep_mode = (mode))
+#define sleep_enable() (sim_sleep_enabled = 1)
+#define sleep_disable() (sim_sleep_enabled = 0)
+#define sleep_cpu() sim_sleep_cpu()
+#define sleep_mode() do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+#define sleep_bod_disable()
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * sim-hal.h: Hooks between the fake avr-libc headers and the simulator.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+// Only the firmware side uses this.  The headers in include/avr/ and
+// include/util/ stand in for avr-libc, and turn register access, delays,
+// sleep, and the watchdog into calls to sim.c.
+
+#include <stdint.h>
+
+// I/O register file  (tiny85 / tiny1634 use I/O addresses as the index)
+#define SIM_IO_SIZE 256
+extern volatile uint8_t sim_io[SIM_IO_SIZE];
+#define SIM_REG8(a)   (sim_io[a])
+#define SIM_REG16(a)  (*(volatile uint16_t *)&sim_io[a])
+// input pins are read through a function, so busy-waiting on a pin
+// (like "while (button_is_pressed()) {}") lets simulated time pass
+#define SIM_PIN8(a)   (*sim_pin(a))
+volatile uint8_t *sim_pin(uint8_t addr);
+
+// status register, with the global interrupt flag in bit 7
+#define SIM_SREG 0x3F
+#define SIM_SREG_I 7
+
+// interrupts
+void sim_sei(void);
+void sim_cli(void);
+
+// time passes...
+void sim_cpu_cycles(uint32_t cycles);  // busy-wait, like _delay_loop_*()
+void sim_sleep_cpu(void);              // sleep until an interrupt
+extern uint8_t sim_sleep_mode;         // set_sleep_mode()
+extern uint8_t sim_sleep_enabled;      // sleep_enable() / sleep_disable()
+
+// watchdog  (FSM only uses it to reboot)
+void sim_wdt_reset(void);
+void sim_wdt_disable(void);
+
+// flash contents, for code which reads raw addresses
+uint8_t sim_flash_byte(uint16_t addr);
+
+// eeprom
+uint8_t sim_eeprom_read(uint16_t addr);
+void sim_eeprom_write(uint16_t addr, uint8_t value);
+
+#endif
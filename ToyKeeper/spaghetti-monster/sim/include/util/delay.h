@@ -0,0 +1,37 @@
+/*
+ * util/delay.h: Simulated delays, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_UTIL_DELAY_H
+#define SIM_UTIL_DELAY_H
+
+#include <util/delay_basic.h>
+
+#ifndef F_CPU
+#error F_CPU needs to be defined before util/delay.h
+#endif
+
+// counted in CPU cycles, so they get slower when the clock is divided
+static inline void _delay_ms(double ms) {
+    sim_cpu_cycles((uint32_t)(ms * (F_CPU / 1000.0)));
+}
+static inline void _delay_us(double us) {
+    sim_cpu_cycles((uint32_t)(us * (F_CPU / 1000000.0)));
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * util/delay_basic.h: Simulated busy-wait loops, for host builds.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_UTIL_DELAY_BASIC_H
+#define SIM_UTIL_DELAY_BASIC_H
+
+#include <stdint.h>
+#include "sim-hal.h"
+
+// same cycle counts as the real loops
+static inline void _delay_loop_1(uint8_t count) {
+    sim_cpu_cycles(3 * (count ? count : 256));
+}
+static inline void _delay_loop_2(uint16_t count) {
+    sim_cpu_cycles(4 * (count ? count : 65536UL));
+}
+
+#endif
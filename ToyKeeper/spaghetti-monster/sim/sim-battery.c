@@ -0,0 +1,255 @@
+/*
+ * sim-battery.c: Runs an FSM program on a simulated battery, to see how
+ *                its low-voltage protection behaves.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Usage:  SIM_DRIVER=../sim/sim-battery.c ../sim/build.sh anduril cfg-foo.h
+//         anduril.foo.sim [name=value ...] script ...
+// The name=value args describe the light, with the same load args as
+// sim-energy.c (pwm1=350, aux_high=3, drain=0.02, etc), plus:
+//   cells=1      in series
+//   mah=3000     capacity
+//   ohms=0.05    resistance of the pack and its path to the driver
+//   direct=pwm2  outputs which run straight off the battery  (FETs)
+//   boost=1      the driver draws constant power, not current
+//   soc=100      charge at the start, in percent
+// Each cell has an open-circuit voltage which depends on its charge,
+// and the voltage sags under load:  instantly from the resistance, and
+// then a bit more over the next half minute or so (and it recovers the
+// same way when the load drops).  Regulated outputs draw a fixed
+// current, direct outputs draw less when the voltage sags, and boost
+// drivers draw more.  Load currents are at NOMINAL_VOLTS per cell.
+//
+// Scripts use the same commands as sim-run.c (except "volts", since the
+// model sets the voltage now), plus:
+//   measure      start measuring here
+//   discharge T  let time pass until the light turns itself off, or T
+// At the end, it prints:
+//   battery RUNTIME_S FIRST_STEPDOWN_S STEPDOWNS RISES MAH SOC_PCT
+// ... where RUNTIME_S is how long it stayed on after "measure" (or -1
+// if it didn't turn off), STEPDOWNS counts drops in brightness which
+// the button didn't cause, and RISES counts times it went back up
+// without the button, which means LVP is fighting something.  MAH is
+// how much charge it used, and SOC_PCT is what's left.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "sim-script.h"
+
+#define NOMINAL_VOLTS 3.7  // per cell, where the load currents are
+#define LED_KNEE 2.7       // direct outputs stop conducting around here
+#define SAG_OHMS 0.5       // slow sag, as a fraction of ohms
+#define SAG_SECONDS 30
+#define MAX_STEP 1.0       // seconds between voltage updates, at most
+
+// open-circuit voltage per cell, at 0%, 10%, ... 100% charge
+static const double ocv[] = {
+    2.80, 3.45, 3.55, 3.62, 3.68, 3.74, 3.80, 3.88, 3.96, 4.06, 4.20 };
+
+#define MAX_MODEL 16
+static struct { char name[16]; double ma; uint8_t direct; } model[MAX_MODEL];
+static uint8_t model_len;
+static double aux_high, aux_low, drain;
+static const char *direct = "";
+static double cells = 1, mah = 3000, ohms = -1, soc = 100;
+static uint8_t boost;
+
+static double sag;  // volts, the slow part
+
+// since "measure"
+static uint8_t measuring, last_level, off;
+static double seconds, mas, runtime = -1, first = -1;
+static uint32_t stepdowns, rises;
+
+static double open_volts() {
+    double x = soc / 10;
+    int i = (int)x;
+    if (i < 0) return ocv[0] * cells;
+    if (i >= 10) return ocv[10] * cells;
+    return (ocv[i] + ((ocv[i+1] - ocv[i]) * (x - i))) * cells;
+}
+
+// what the outputs draw, in mA at NOMINAL_VOLTS, by type
+typedef struct Load {
+    double fixed;   // regulated, and aux LEDs
+    double direct;  // FETs
+    double boost;
+} Load;
+
+static void get_load(SimOutputs *o, Load *load) {
+    load->fixed = drain + (o->aux_high * aux_high) + (o->aux_low * aux_low);
+    load->direct = load->boost = 0;
+    for (uint8_t i=0; i<o->channels; i++) {
+        if (! o->top[i]) continue;
+        for (uint8_t j=0; j<model_len; j++) {
+            double ma = model[j].ma * o->pwm[i] / o->top[i];
+            if (strcmp(model[j].name, o->name[i])) continue;
+            if (model[j].direct) load->direct += ma;
+            else if (boost) load->boost += ma;
+            else load->fixed += ma;
+        }
+    }
+}
+
+// battery current in mA, at the pack's voltage v
+static double load_ma(Load *load, double v) {
+    double per_cell = v / cells;
+    double ma = load->fixed;
+    if (per_cell > LED_KNEE)
+        ma += load->direct * (per_cell - LED_KNEE) / (NOMINAL_VOLTS - LED_KNEE);
+    ma += load->boost * NOMINAL_VOLTS / (per_cell > 0.5 ? per_cell : 0.5);
+    return ma;
+}
+
+// the pack's voltage under load, and its current
+static double pack_volts(Load *load, double *ma) {
+    double e = open_volts() - sag;
+    double v = e;
+    // (damped, because boost drivers pull harder as the voltage drops)
+    for (uint8_t i=0; i<32; i++) {
+        *ma = load_ma(load, v);
+        v = (v + e - (*ma / 1000 * ohms)) / 2;
+        if (v < 0) v = 0;
+    }
+    return v;
+}
+
+static void battery_hook(uint64_t dt) {
+    // (this runs for every interrupt, so only solve for the voltage when
+    //  the load changes, or when the battery has had time to change)
+    static Load last;
+    static double ma, v, age;
+    SimOutputs o;
+    SimInternals in;
+    Load load;
+    double s = dt / 1e12;
+    sim_outputs(&o);
+    get_load(&o, &load);
+    if (memcmp(&load, &last, sizeof(load)) || (age >= MAX_STEP)) {
+        v = pack_volts(&load, &ma);
+        sim_volts = v / cells;
+        last = load;
+        age = 0;
+    }
+    age += s;
+    soc -= ma * s / 36 / mah;  // (mA * s / (mAh * 3600) * 100%)
+    if (soc < 0) soc = 0;
+    sag += ((ma / 1000 * ohms * SAG_OHMS) - sag) * (s < SAG_SECONDS ? s : SAG_SECONDS) / SAG_SECONDS;
+
+    if (! measuring) return;
+    seconds += s;
+    mas += ma * s;
+    // what did the light do on its own?
+    if (o.level != last_level) {
+        if (sim_button_state) {}
+        else if (o.level < last_level) {
+            if (first < 0) first = seconds;
+            stepdowns ++;
+        }
+        else rises ++;
+        last_level = o.level;
+        sim_internals(&in);
+        if (in.off && ! off) runtime = seconds;
+        off = in.off;
+    }
+}
+
+static uint8_t battery_cmd(const char *cmd, FILE *f) {
+    SimOutputs o;
+    if (! strcmp(cmd, "volts")) {
+        fprintf(stderr, "volts: the battery model sets the voltage\n");
+        exit(1);
+    }
+    if (! strcmp(cmd, "discharge")) {
+        uint64_t t = sim_parse_time(sim_script_arg(f, cmd));
+        uint64_t step = 1000 * SIM_PS_PER_MS;
+        for (uint64_t done=0; (done < t) && (runtime < 0); done += step)
+            sim_run(step);
+        return 1;
+    }
+    if (strcmp(cmd, "measure")) return 0;
+    measuring = 1;
+    seconds = mas = 0;
+    runtime = first = -1;
+    stepdowns = rises = 0;
+    sim_outputs(&o);
+    last_level = o.level;
+    off = 0;
+    return 1;
+}
+
+static void start() {
+    Load load = { drain, 0, 0 };
+    double ma;
+    for (uint8_t j=0; j<model_len; j++)
+        model[j].direct = !! strstr(direct, model[j].name);
+    if (ohms < 0) ohms = 0.05 * cells;
+    sim_volts = pack_volts(&load, &ma) / cells;
+    sim_power_on();
+}
+
+int main(int argc, char **argv) {
+    int scripts = 0;
+
+    sim_hook = battery_hook;
+    sim_script_ext = battery_cmd;
+    for (int i=1; i<argc; i++) {
+        char *eq = strchr(argv[i], '=');
+        if (eq) {
+            double value = atof(eq + 1);
+            *eq = 0;
+            if (! strcmp(argv[i], "aux_high")) aux_high = value;
+            else if (! strcmp(argv[i], "aux_low")) aux_low = value;
+            else if (! strcmp(argv[i], "drain")) drain = value;
+            else if (! strcmp(argv[i], "cells")) cells = value;
+            else if (! strcmp(argv[i], "mah")) mah = value;
+            else if (! strcmp(argv[i], "ohms")) ohms = value;
+            else if (! strcmp(argv[i], "soc")) soc = value;
+            else if (! strcmp(argv[i], "boost")) boost = (value != 0);
+            else if (! strcmp(argv[i], "direct")) direct = eq + 1;
+            else if (model_len < MAX_MODEL) {
+                strncpy(model[model_len].name, argv[i], sizeof(model[0].name)-1);
+                model[model_len++].ma = value;
+            }
+            continue;
+        }
+        if (! scripts) start();
+        FILE *f = strcmp(argv[i], "-") ? fopen(argv[i], "r") : stdin;
+        if (! f) { perror(argv[i]); return 1; }
+        sim_script(f);
+        if (f != stdin) fclose(f);
+        scripts ++;
+    }
+    if (! scripts) {
+        start();
+        sim_script(stdin);
+    }
+
+    printf("# %s: ", sim_fw_config);
+    if (runtime < 0) printf("still on after %.0f s", seconds);
+    else printf("ran for %.0f s", runtime);
+    printf(", %u stepdowns (first at %.0f s), %u rises\n",
+           stepdowns, first, rises);
+    printf("#   used %.0f mAh, %.1f%% left, %.2f V per cell at rest\n",
+           mas / 3600, soc, (open_volts() - sag) / cells);
+    printf("battery %.0f %.0f %u %u %.1f %.1f\n",
+           runtime, first, stepdowns, rises, mas / 3600, soc);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * sim-energy.c: Estimates battery drain of an FSM program.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Usage:  SIM_DRIVER=../sim/sim-energy.c ../sim/build.sh anduril cfg-foo.h
+//         anduril.foo.sim [name=mA ...] script ...
+// The name=mA args describe the light:
+//   pwm1=350    current at 100% duty, for each output  (pwmN, tintN)
+//   aux_high=4  current per aux LED, on high
+//   aux_low=0.05  ... and on low  (through the pull-up)
+//   drain=0.02  anything which is always on, like a voltage divider
+// Current on each output scales with its duty cycle, which is close
+// enough for 7135 chips, FETs, and linear regulators alike.  The MCU's
+// own current depends on its clock speed and sleep mode.
+//
+// Scripts use the same commands as sim-run.c, plus:
+//   measure    start over, ignoring everything before this
+// At the end, it prints the average current and total mAh, like:
+//   energy SECONDS AVG_MA MAH MCU_MA LED_MA AUX_MA
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "sim-script.h"
+#include <avr/sleep.h>  // (the simulated one, for SLEEP_MODE_*)
+
+// MCU current in mA, roughly, from the datasheets at 3-4V
+typedef struct McuPower {
+    double active;     // per MHz, running
+    double idle;       // per MHz, in idle or ADC noise reduction sleep
+    double powerdown;  // power-down / standby, with WDT or PIT running
+    double off;        // ... without
+    double adc;        // extra, while the ADC is enabled
+} McuPower;
+#if (ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85)
+static const McuPower mcu = { 0.45, 0.13, 0.005, 0.0002, 0.25 };
+#elif (ATTINY == 1634)
+static const McuPower mcu = { 0.40, 0.10, 0.002, 0.0002, 0.25 };
+#else  // tinyAVR 1-series
+static const McuPower mcu = { 0.40, 0.15, 0.0008, 0.0001, 0.30 };
+#endif
+
+#define MAX_MODEL 16
+static struct { char name[16]; double ma; } model[MAX_MODEL];
+static uint8_t model_len;
+static double aux_high, aux_low, drain;
+
+// charge used so far, in mA * seconds
+static double mcu_mas, led_mas, aux_mas, seconds;
+
+static double model_ma(const char *name) {
+    for (uint8_t i=0; i<model_len; i++)
+        if (! strcmp(model[i].name, name)) return model[i].ma;
+    return 0;
+}
+
+static double mcu_ma() {
+    double mhz = sim_cpu.hz / 1e6;
+    double ma;
+    if (! sim_cpu.asleep) ma = mcu.active * mhz;
+    else if ((sim_cpu.sleep_mode == SLEEP_MODE_IDLE)
+             || (sim_cpu.sleep_mode == SLEEP_MODE_ADC))
+        ma = mcu.idle * mhz;
+    else ma = sim_cpu.wdt_on ? mcu.powerdown : mcu.off;
+    if (sim_cpu.adc_on) ma += mcu.adc;
+    return ma + drain;
+}
+
+static void energy_hook(uint64_t dt) {
+    SimOutputs o;
+    double s = dt / 1e12;
+    double led = 0;
+    sim_outputs(&o);
+    for (uint8_t i=0; i<o.channels; i++)
+        if (o.top[i]) led += model_ma(o.name[i]) * o.pwm[i] / o.top[i];
+    mcu_mas += mcu_ma() * s;
+    led_mas += led * s;
+    aux_mas += ((o.aux_high * aux_high) + (o.aux_low * aux_low)) * s;
+    seconds += s;
+}
+
+static uint8_t energy_cmd(const char *cmd, FILE *f) {
+    (void)f;
+    if (strcmp(cmd, "measure")) return 0;
+    mcu_mas = led_mas = aux_mas = seconds = 0;
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    int scripts = 0;
+    double total;
+
+    sim_hook = energy_hook;
+    sim_script_ext = energy_cmd;
+    sim_power_on();
+    for (int i=1; i<argc; i++) {
+        char *eq = strchr(argv[i], '=');
+        if (eq) {
+            double ma = atof(eq + 1);
+            *eq = 0;
+            if (! strcmp(argv[i], "aux_high")) aux_high = ma;
+            else if (! strcmp(argv[i], "aux_low")) aux_low = ma;
+            else if (! strcmp(argv[i], "drain")) drain = ma;
+            else if (model_len < MAX_MODEL) {
+                strncpy(model[model_len].name, argv[i], sizeof(model[0].name)-1);
+                model[model_len++].ma = ma;
+            }
+            continue;
+        }
+        FILE *f = strcmp(argv[i], "-") ? fopen(argv[i], "r") : stdin;
+        if (! f) { perror(argv[i]); return 1; }
+        sim_script(f);
+        if (f != stdin) fclose(f);
+        scripts ++;
+    }
+    if (! scripts) sim_script(stdin);
+
+    if (seconds <= 0) seconds = 1e-12;
+    total = mcu_mas + led_mas + aux_mas;
+    printf("# %s: %.1f hours, %.4f mA average, %.3f mAh\n",
+           sim_fw_config, seconds / 3600, total / seconds, total / 3600);
+    printf("#   MCU %.4f mA, LEDs %.4f mA, aux %.4f mA\n",
+           mcu_mas / seconds, led_mas / seconds, aux_mas / seconds);
+    printf("energy %.3f %.6f %.6f %.6f %.6f %.6f\n", seconds,
+           total / seconds, total / 3600,
+           mcu_mas / seconds, led_mas / seconds, aux_mas / seconds);
+    return 0;
+}
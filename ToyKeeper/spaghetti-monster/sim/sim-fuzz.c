@@ -0,0 +1,513 @@
+/*
+ * sim-fuzz.c: Coverage-guided fuzzer for FSM programs in the simulator.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Usage:  SIM_DRIVER=../sim/sim-fuzz.c
+//             ../sim/build.sh anduril cfg-foo.h -fsanitize-coverage=trace-pc
+//         anduril.foo.sim [options] corpus_dir [crash_dir]
+//         anduril.foo.sim [-v] input_file ...
+// Options:
+//   -t SECONDS  stop fuzzing after this long  (default 60)
+//   -n RUNS     ... or after this many inputs
+//   -s SEED     random seed for mutations
+//   -l BYTES    longest input to try  (default 64)
+//   -v          show each action and the outputs  (for input files)
+//
+// With a directory, it runs everything in the corpus first, then keeps
+// mutating those inputs, and saves any which reach new code in the
+// firmware (found with gcc's -fsanitize-coverage=trace-pc).  It stops at
+// the first input which breaks an invariant, and saves it in crash_dir
+// (default: the current directory).  With a file, it just runs it.
+//
+// Each byte of an input is one action:  the top 3 bits pick what to do,
+// and the low 5 bits (n) say how much.
+//   0: toggle the button, wait (n+1)*12 ms     (clicks, release timeouts)
+//   1: toggle the button, wait (n+1)*500 ms    (holds)
+//   2: wait (n+1)*2 s
+//   3: set the battery to 2.5 + n*0.06 V
+//   4: set the temperature to n*3 C
+//   5: n+1 quick clicks
+//   6: bounce:  toggle the button for (n+1)*250 us, then toggle it back
+//   7: n < 4: disconnect and reconnect power;  else wait n s
+// At the end, it lets go of the button and waits a few seconds.
+//
+// Invariants, checked every time simulated time passes:
+//   - the emission queue never overflows
+//   - the state stack never fills up  (push_state() would fail)
+//   - the ramp level never goes above MAX_LEVEL
+//   - no watchdog resets  (except with the button held, for 13H),
+//     and main() never returns
+//   - after a minute of low voltage, LVP has stepped the light down
+//   - after two minutes well above the temperature limit in the normal
+//     ramp mode, thermal regulation has stepped it down
+//   - the main LEDs don't stay on in off or lockout mode
+// (with the button released the whole time, since the user can turn
+//  it back up on purpose)
+// A simulator hang (code which spins without ever letting time pass)
+// gets caught by a wall-clock timeout, and saved like other crashes.
+//
+// It also works as a libFuzzer target:  build with CC=clang, use
+// -fsanitize=fuzzer-no-link instead of trace-pc, and set
+// SIM_DRIVER_FLAGS=-DSIM_LIBFUZZER and SIM_LDFLAGS=-fsanitize=fuzzer.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "sim.h"
+#include "sim-script.h"
+
+#define LVP_MS 60000ULL       // how long LVP gets to step down
+#define THERM_MS 120000ULL    // ... and thermal regulation  (it's gradual)
+#define STUCK_MS 2000ULL      // how long the LEDs can stay on while off
+#define THERM_MARGIN 10       // C above the limit, to count as too hot
+#define TAIL_MS 3000          // wait after the last action
+#define HANG_SECONDS 20       // wall-clock time for one input
+
+static uint8_t verbose;
+static char violation[128];
+static uint32_t resets_before;
+
+// when each condition started, or 0
+static uint64_t last_input, lvp_since, hot_since, off_since;
+
+#define since(t) ((sim_now - (t)) / SIM_PS_PER_MS)
+
+static void fail(const char *msg, int a, int b) {
+    if (! violation[0])
+        snprintf(violation, sizeof(violation), "%.3f s: %s (%d, %d)",
+                 sim_now / 1e12, msg, a, b);
+}
+
+static void check_hook(uint64_t dt) {
+    SimInternals in;
+    uint64_t quiet;
+    (void)dt;
+    if (violation[0]) return;
+    sim_internals(&in);
+
+    if (in.queue_overflows)
+        fail("emission queue overflowed", in.queue_overflows, in.queue_size);
+    if (in.queue_len > in.queue_size)
+        fail("emission queue too long", in.queue_len, in.queue_size);
+    if (in.stack_len >= in.stack_size)
+        fail("state stack full", in.stack_len, in.stack_size);
+    if (in.level > in.max_level)
+        fail("level above MAX_LEVEL", in.level, in.max_level);
+    if (in.release_ceil && ((in.release_timeout < in.release_floor)
+                            || (in.release_timeout > in.release_ceil)))
+        fail("release timeout out of range", in.release_timeout, in.release_ceil);
+    // (13H from off reboots on purpose, so only count it while released)
+    if ((sim_resets != resets_before) && (! sim_button_state))
+        fail("watchdog reset", sim_resets - resets_before, 0);
+    resets_before = sim_resets;
+
+    // the slow ones only count while nobody touches the button
+    quiet = last_input;
+
+    if (! in.lvp) lvp_since = 0;
+    else if (! lvp_since) lvp_since = sim_now;
+    if (lvp_since && (! sim_button_state)
+            && (since(lvp_since > quiet ? lvp_since : quiet) > LVP_MS)
+            && (in.level > in.max_level / 6))
+        fail("LVP didn't step down", in.level, in.max_level / 6);
+
+    if (! (in.steady && in.therm_ceil
+           && (in.temperature >= in.therm_ceil + THERM_MARGIN)))
+        hot_since = 0;
+    else if (! hot_since) hot_since = sim_now;
+    if (hot_since && (! sim_button_state)
+            && (since(hot_since > quiet ? hot_since : quiet) > THERM_MS)
+            && (in.level > in.therm_floor))
+        fail("thermal regulation didn't step down", in.level, in.therm_floor);
+
+    if (! (in.off && in.level)) off_since = 0;
+    else if (! off_since) off_since = sim_now;
+    if (off_since && (! sim_button_state)
+            && (since(off_since > quiet ? off_since : quiet) > STUCK_MS))
+        fail("LEDs stuck on while off", in.level, 0);
+}
+
+static void button(uint8_t pressed) {
+    sim_button(pressed);
+    last_input = sim_now;
+}
+
+static void act(uint8_t b) {
+    uint8_t n = b & 0x1f;
+    switch (b >> 5) {
+        case 0:
+            button(! sim_button_state);
+            sim_run_ms((n+1) * 12);
+            break;
+        case 1:
+            button(! sim_button_state);
+            sim_run_ms((n+1) * 500);
+            break;
+        case 2:
+            sim_run_ms((n+1) * 2000ULL);
+            break;
+        case 3:
+            sim_volts = 2.5 + (n * 0.06);
+            break;
+        case 4:
+            sim_celsius = n * 3;
+            break;
+        case 5:
+            for (uint8_t i=0; i<=n; i++) {
+                button(1);
+                sim_run_ms(CLICK_MS);
+                button(0);
+                sim_run_ms(CLICK_MS);
+            }
+            break;
+        case 6:
+            button(! sim_button_state);
+            sim_run((n+1) * 250 * SIM_PS_PER_US);
+            button(! sim_button_state);
+            break;
+        case 7:
+            if (n < 4) {
+                sim_power_on();
+                last_input = sim_now;
+            }
+            else sim_run_ms(n * 1000);
+            break;
+    }
+}
+
+// run one input on a brand new light, and return 1 if it broke something
+static uint8_t run_input(const uint8_t *data, size_t size) {
+    SimOutputs o;
+
+    violation[0] = 0;
+    sim_button(0);
+    sim_volts = 4.0;
+    sim_celsius = 25.0;
+    memset(sim_eeprom, 0xff, sim_eeprom_size);
+    srand(0);  // (for the noinit RAM contents)
+    sim_power_on();
+    resets_before = sim_resets;
+    last_input = sim_now;
+    lvp_since = hot_since = off_since = 0;
+    sim_hook = check_hook;
+
+    for (size_t i=0; (i < size) && (! violation[0]); i++) {
+        act(data[i]);
+        if (verbose) {
+            SimInternals in;
+            sim_internals(&in);
+            printf("%02x %c %s%s%s %3dC ", data[i],
+                   sim_button_state ? 'P' : '-',
+                   in.off ? "off " : in.steady ? "ramp" : "    ",
+                   in.lvp ? " lvp" : "    ",
+                   (in.temperature >= in.therm_ceil + THERM_MARGIN) ? " hot" : "    ",
+                   in.temperature);
+            sim_outputs(&o);
+            sim_show(&o);
+        }
+    }
+    if (! violation[0]) {
+        button(0);
+        sim_run_ms(TAIL_MS);
+    }
+    if (sim_halted) fail("main() returned", 0, 0);
+    sim_hook = NULL;
+    return violation[0] != 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (run_input(data, size)) {
+        fprintf(stderr, "%s: %s\n", sim_fw_config, violation);
+        abort();
+    }
+    return 0;
+}
+
+
+#ifndef SIM_LIBFUZZER
+
+// edge coverage, AFL-style:  hash of (previous block, this block)
+// (only whether each edge ran, not how often, because clock ticks make
+//  most hit counts depend on timing instead of on what the UI did)
+#define MAP_SIZE 65536
+static uint8_t cov[MAP_SIZE];
+static uint8_t seen[MAP_SIZE];
+static uintptr_t cov_prev;
+
+void __sanitizer_cov_trace_pc(void) {
+    uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+    cov[((uint32_t)(pc ^ cov_prev) * 0x9e3779b1u) >> 16] = 1;
+    cov_prev = pc >> 1;
+}
+
+// how many edges this run reached for the first time
+static uint32_t new_coverage(uint32_t *edges) {
+    uint32_t found = 0;
+    for (uint32_t i=0; i<MAP_SIZE; i++) {
+        if (cov[i] && (! seen[i])) {
+            seen[i] = 1;
+            found ++;
+        }
+    }
+    *edges += found;
+    return found;
+}
+
+// corpus
+#define MAX_CORPUS 4096
+#define MAX_LEN 1024
+typedef struct Input {
+    uint8_t *data;
+    size_t len;
+} Input;
+static Input corpus[MAX_CORPUS];
+static uint32_t corpus_len;
+
+// the input being run, so a hang can be saved
+static uint8_t current[MAX_LEN];
+static size_t current_len;
+static const char *crash_dir = ".";
+
+static uint64_t rng = 0x853c49e6748fea9bULL;
+static uint32_t rnd(uint32_t n) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return n ? (uint32_t)(rng % n) : 0;
+}
+
+static uint64_t hash(const uint8_t *data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;  // FNV-1a
+    for (size_t i=0; i<len; i++) h = (h ^ data[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+static void save(const char *dir, const char *prefix,
+                 const uint8_t *data, size_t len) {
+    char path[1024];
+    int fd;
+    snprintf(path, sizeof(path), "%s/%s%016llx", dir, prefix,
+             (unsigned long long)hash(data, len));
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { perror(path); return; }
+    if (write(fd, data, len) != (ssize_t)len) perror(path);
+    close(fd);
+    if (*prefix) printf("saved %s\n", path);
+}
+
+static void hang(int sig) {
+    (void)sig;
+    printf("%s: hang (one input ran for %d s)\n",
+           sim_fw_config, HANG_SECONDS);
+    save(crash_dir, "hang-", current, current_len);
+    fflush(stdout);
+    _exit(1);
+}
+
+static void add(const uint8_t *data, size_t len) {
+    if (corpus_len >= MAX_CORPUS) return;
+    corpus[corpus_len].data = malloc(len + 1);
+    memcpy(corpus[corpus_len].data, data, len);
+    corpus[corpus_len++].len = len;
+}
+
+// returns 1 if it broke something
+static uint8_t fuzz_one(const uint8_t *data, size_t len) {
+    uint8_t broke;
+    memcpy(current, data, len);
+    current_len = len;
+    memset(cov, 0, sizeof(cov));
+    cov_prev = 0;
+    alarm(HANG_SECONDS);
+    broke = run_input(current, len);
+    alarm(0);
+    if (broke) {
+        printf("%s: %s\n", sim_fw_config, violation);
+        save(crash_dir, "crash-", data, len);
+    }
+    return broke;
+}
+
+static size_t mutate(uint8_t *buf, size_t len, size_t max_len) {
+    uint8_t count = 1 + rnd(4);
+    while (count--) {
+        switch (rnd(7)) {
+            case 0:  // flip a bit
+                if (len) buf[rnd(len)] ^= 1 << rnd(8);
+                break;
+            case 1:  // new action
+                if (len) buf[rnd(len)] = rnd(256);
+                break;
+            case 2:  // same action, different amount
+                if (len) {
+                    size_t i = rnd(len);
+                    buf[i] = (buf[i] & 0xe0) | rnd(32);
+                }
+                break;
+            case 3:  // insert
+                if (len < max_len) {
+                    size_t i = rnd(len + 1);
+                    memmove(buf + i + 1, buf + i, len - i);
+                    buf[i] = rnd(256);
+                    len ++;
+                }
+                break;
+            case 4:  // delete some
+                if (len) {
+                    size_t i = rnd(len);
+                    size_t n = 1 + rnd(len - i);
+                    if (n > 4) n = 1 + rnd(4);
+                    memmove(buf + i, buf + i + n, len - i - n);
+                    len -= n;
+                }
+                break;
+            case 5:  // repeat a chunk  (more clicks, longer holds)
+                if (len && (len < max_len)) {
+                    size_t i = rnd(len);
+                    size_t n = 1 + rnd(len - i);
+                    if (n > max_len - len) n = max_len - len;
+                    memmove(buf + i + n, buf + i, len - i);
+                    len += n;
+                }
+                break;
+            case 6:  // splice in part of another input
+                if (corpus_len) {
+                    Input *other = corpus + rnd(corpus_len);
+                    size_t i = rnd(len + 1);
+                    size_t n = rnd(other->len + 1);
+                    if (i + n > max_len) n = max_len - i;
+                    memcpy(buf + i, other->data, n);
+                    if (i + n > len) len = i + n;
+                }
+                break;
+        }
+    }
+    return len;
+}
+
+static size_t load(const char *path, uint8_t *buf) {
+    FILE *f = fopen(path, "rb");
+    size_t len;
+    if (! f) { perror(path); return 0; }
+    len = fread(buf, 1, MAX_LEN, f);
+    fclose(f);
+    return len;
+}
+
+int main(int argc, char **argv) {
+    double seconds = 60;
+    uint32_t max_runs = 0;
+    size_t max_len = 64;
+    const char *dir = NULL;
+    uint8_t buf[MAX_LEN];
+    uint32_t runs = 0, edges = 0, found = 0, files = 0;
+    uint8_t broke = 0;
+    time_t start = time(NULL);
+    DIR *d;
+    struct dirent *ent;
+    int i;
+
+    for (i=1; i<argc; i++) {
+        struct stat st;
+        if ((! strcmp(argv[i], "-t")) && (i+1 < argc)) seconds = atof(argv[++i]);
+        else if ((! strcmp(argv[i], "-n")) && (i+1 < argc)) max_runs = atol(argv[++i]);
+        else if ((! strcmp(argv[i], "-s")) && (i+1 < argc)) rng ^= atoll(argv[++i]) * 0x9e3779b97f4a7c15ULL;
+        else if ((! strcmp(argv[i], "-l")) && (i+1 < argc)) max_len = atol(argv[++i]);
+        else if (! strcmp(argv[i], "-v")) verbose = 1;
+        else if (dir) crash_dir = argv[i];
+        else if ((! stat(argv[i], &st)) && S_ISDIR(st.st_mode)) dir = argv[i];
+        else {
+            // just run it
+            size_t len = load(argv[i], buf);
+            files ++;
+            if (run_input(buf, len)) {
+                printf("%s: %s: %s\n", sim_fw_config, argv[i], violation);
+                broke = 1;
+            }
+            else if (verbose) printf("%s: %s: ok\n", sim_fw_config, argv[i]);
+        }
+    }
+    if (max_len > MAX_LEN) max_len = MAX_LEN;
+    if (! dir) {
+        if (! files) {
+            fprintf(stderr, "Usage: %s [options] corpus_dir [crash_dir]\n"
+                            "       %s [-v] input_file ...\n", argv[0], argv[0]);
+            return 2;
+        }
+        return broke;
+    }
+
+    signal(SIGALRM, hang);
+
+    // run the whole corpus first
+    d = opendir(dir);
+    if (! d) { perror(dir); return 2; }
+    while ((ent = readdir(d))) {
+        char path[1024];
+        size_t len;
+        if (ent->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        len = load(path, buf);
+        runs ++;
+        if (fuzz_one(buf, len)) { broke = 1; break; }
+        new_coverage(&edges);
+        add(buf, len);
+    }
+    closedir(d);
+    if (! corpus_len) {
+        // something to start with:  1C on, then off
+        static const uint8_t seed[] = { 0x05, 0x13, 0x00, 0x13 };
+        runs ++;
+        broke = fuzz_one(seed, sizeof(seed));
+        new_coverage(&edges);
+        add(seed, sizeof(seed));
+        save(dir, "", seed, sizeof(seed));
+    }
+    printf("#%u loaded  edges %u  corpus %u\n", runs, edges, corpus_len);
+    fflush(stdout);
+
+    // then mutate
+    while ((! broke) && (difftime(time(NULL), start) < seconds)
+           && ((! max_runs) || (runs < max_runs))) {
+        Input *in = corpus + rnd(corpus_len);
+        size_t len = in->len;
+        memcpy(buf, in->data, len);
+        len = mutate(buf, len, max_len);
+        runs ++;
+        if (fuzz_one(buf, len)) { broke = 1; break; }
+        if (new_coverage(&edges)) {
+            found ++;
+            add(buf, len);
+            save(dir, "", buf, len);
+            printf("#%u NEW  edges %u  corpus %u  len %u\n",
+                   runs, edges, corpus_len, (unsigned)len);
+            fflush(stdout);
+        }
+    }
+
+    printf("fuzz %u %u %u %u %u\n", runs, edges, corpus_len, found, broke);
+    return broke;
+}
+
+#endif  // ifndef SIM_LIBFUZZER
@@ -0,0 +1,300 @@
+/*
+ * sim-fw.c: Wraps an FSM program for the simulator.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Build with -DSIM_PROGRAM='"anduril.c"' -DCONFIGFILE=cfg-foo.h, and
+// include/ ahead of the real avr-libc.  The program's main() becomes
+// sim_fw_main(), and everything below knows the program's hwdef.
+
+#include <math.h>
+#include "sim.h"
+
+#define main sim_fw_main
+#include SIM_PROGRAM
+#undef main
+
+#define sim_str(x) #x
+#define sim_xstr(x) sim_str(x)
+const uint32_t sim_fw_f_cpu = F_CPU;
+#ifdef CONFIGFILE
+const char sim_fw_config[] = sim_xstr(CONFIGFILE);
+#else
+const char sim_fw_config[] = SIM_PROGRAM;
+#endif
+
+
+// e-switch:  pressed pulls the pin low
+void sim_fw_set_button(uint8_t pressed) {
+    if (pressed) SWITCH_PORT &= ~(1 << SWITCH_PIN);
+    else SWITCH_PORT |= (1 << SWITCH_PIN);
+}
+
+uint8_t sim_fw_button_irq_enabled() {
+    #if (ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85)
+    return (GIMSK & (1 << PCIE)) && (PCMSK & (1 << SWITCH_PCINT));
+    #elif (ATTINY == 1634)
+    return (GIMSK & (1 << SWITCH_PCIE));
+    #elif defined(AVRXMEGA3)
+    uint8_t isc = SWITCH_ISC_REG & PORT_ISC_gm;
+    return (isc != PORT_ISC_INTDISABLE_gc) && (isc != PORT_ISC_INPUT_DISABLE_gc);
+    #endif
+}
+
+void sim_fw_button_isr() {
+    #if (ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85) || (ATTINY == 1634)
+        #ifdef PCINT_vect
+        PCINT_vect();
+        #else
+        PCINT0_vect();
+        #endif
+    #elif defined(AVRXMEGA3)
+        SWITCH_VECT();
+    #endif
+}
+
+
+// Turn sim_volts and sim_celsius into what the ADC would read, by
+// running the firmware's own math backward.  Returns 10 bits.
+static uint16_t sim_adc_clamp(double raw) {
+    if (raw < 0) return 0;
+    if (raw > 1023) return 1023;
+    return (uint16_t)(raw + 0.5);
+}
+
+#ifndef THERM_CAL_OFFSET
+#define THERM_CAL_OFFSET 0
+#endif
+
+#ifdef ADMUX_THERM
+static uint16_t sim_adc_celsius() {
+    #ifdef USE_EXTERNAL_TEMP_SENSOR
+    // no simple inverse, so search
+    uint16_t best = 0;
+    double err = 1e9;
+    for (uint16_t raw=0; raw<1024; raw++) {
+        double e = fabs(EXTERN_TEMP_FORMULA(raw) + THERM_CAL_OFFSET - sim_celsius);
+        if (e < err) { err = e; best = raw; }
+    }
+    return best;
+    #else
+    return sim_adc_clamp(sim_celsius + 275 - THERM_CAL_OFFSET);
+    #endif
+}
+#endif
+
+#ifndef VOLTAGE_FUDGE_FACTOR
+#define VOLTAGE_FUDGE_FACTOR 0
+#endif
+
+// Vcc, measured against the 1.1V reference:  ADC = 1.1 * 1024 / volts
+static uint16_t sim_adc_vcc() {
+    double v = sim_volts - (VOLTAGE_FUDGE_FACTOR * 0.05);
+    if (v < 0.1) v = 0.1;
+    return sim_adc_clamp(1126.4 / v);
+}
+
+#ifdef USE_VOLTAGE_DIVIDER
+static uint16_t sim_adc_divider() {
+    return sim_adc_clamp((sim_volts * 10 - VOLTAGE_FUDGE_FACTOR)
+                         * (ADC_44 - ADC_22) / 22.0);
+}
+#endif
+
+uint16_t sim_fw_adc() {
+    #ifdef AVRXMEGA3
+    switch (ADC0.MUXPOS) {
+        case ADC_MUXPOS_TEMPSENSE_gc:
+            // with SIGROW gain 128 and offset 0, Kelvin = RES / 2
+            return sim_adc_clamp(2.0 * (sim_celsius + 275 - THERM_CAL_OFFSET));
+        case ADC_MUXPOS_INTREF_gc:
+            return sim_adc_vcc();
+        #ifdef USE_VOLTAGE_DIVIDER
+        default:
+            return sim_adc_divider();
+        #endif
+    }
+    return 0;
+    #else
+    uint8_t mux = ADMUX & 0x0F;
+    #ifdef ADMUX_THERM
+    if (mux == (ADMUX_THERM & 0x0F)) return sim_adc_celsius();
+    #endif
+    #ifdef USE_VOLTAGE_DIVIDER
+    if (mux == (ADMUX_VOLTAGE_DIVIDER & 0x0F)) return sim_adc_divider();
+    #endif
+    if (mux == (ADMUX_VCC & 0x0F)) return sim_adc_vcc();
+    return 0;
+    #endif
+}
+
+
+// PWM outputs, and the TOP value each one counts to
+#if defined(AVRXMEGA3)
+#define SIM_PWM_TOP (TCA0.SINGLE.PER ? TCA0.SINGLE.PER : 0xffff)
+#elif defined(PWM_TOP)
+#define SIM_PWM_TOP PWM_TOP
+#else
+#define SIM_PWM_TOP 1023
+#endif
+#define sim_channel(nm, lvl, top_reg) do { \
+    uint8_t c = out->channels++; \
+    out->name[c] = nm; \
+    out->pwm[c] = lvl; \
+    out->top[c] = (top_reg) ? (top_reg) : (sizeof(lvl) == 1) ? 255 : SIM_PWM_TOP; \
+    } while (0)
+
+// aux LEDs are either driven high, or lit dimly by the pull-up
+#ifdef AVRXMEGA3
+#define sim_aux(port, pin) do { \
+    if (port.DIR & (1 << (pin))) { \
+        if (port.OUT & (1 << (pin))) out->aux_high++; \
+    } \
+    else if (*((uint8_t *)&port + 0x10 + (pin)) & PORT_PULLUPEN_bm) out->aux_low++; \
+    } while (0)
+#else
+#define sim_aux(ddr, pue, port, pin) do { \
+    if (ddr & (1 << (pin))) { \
+        if (port & (1 << (pin))) out->aux_high++; \
+    } \
+    else if (pue & (1 << (pin))) out->aux_low++; \
+    } while (0)
+#endif
+
+void sim_fw_outputs(SimOutputs *out) {
+    #ifdef PWM1_LVL
+    #ifdef PWM1_TOP
+    sim_channel("pwm1", PWM1_LVL, PWM1_TOP);
+    #else
+    sim_channel("pwm1", PWM1_LVL, 0);
+    #endif
+    #endif
+    #ifdef PWM2_LVL
+    #ifdef PWM2_TOP
+    sim_channel("pwm2", PWM2_LVL, PWM2_TOP);
+    #else
+    sim_channel("pwm2", PWM2_LVL, 0);
+    #endif
+    #endif
+    #ifdef PWM3_LVL
+    #ifdef PWM3_TOP
+    sim_channel("pwm3", PWM3_LVL, PWM3_TOP);
+    #else
+    sim_channel("pwm3", PWM3_LVL, 0);
+    #endif
+    #endif
+    #ifdef PWM4_LVL
+    #ifdef PWM4_TOP
+    sim_channel("pwm4", PWM4_LVL, PWM4_TOP);
+    #else
+    sim_channel("pwm4", PWM4_LVL, 0);
+    #endif
+    #endif
+    // tint ramping splits the (virtual) PWM1 into two real outputs
+    #ifdef TINT1_LVL
+    #ifdef PWM1_TOP
+    sim_channel("tint1", TINT1_LVL, PWM1_TOP);
+    #else
+    sim_channel("tint1", TINT1_LVL, 0);
+    #endif
+    #endif
+    #ifdef TINT2_LVL
+    #ifdef PWM1_TOP
+    sim_channel("tint2", TINT2_LVL, PWM1_TOP);
+    #else
+    sim_channel("tint2", TINT2_LVL, 0);
+    #endif
+    #endif
+    #ifdef AVRXMEGA3
+        #ifdef AUXLED_PIN
+        sim_aux(AUXLED_PORT, AUXLED_PIN);
+        #endif
+        #ifdef AUXLED2_PIN
+        sim_aux(AUXLED2_PORT, AUXLED2_PIN);
+        #endif
+        #ifdef AUXLED_RGB_PORT
+        sim_aux(AUXLED_RGB_PORT, AUXLED_R_PIN);
+        sim_aux(AUXLED_RGB_PORT, AUXLED_G_PIN);
+        sim_aux(AUXLED_RGB_PORT, AUXLED_B_PIN);
+        #endif
+    #else
+        // (indicator_led() always uses port B)
+        #ifdef AUXLED_PIN
+        sim_aux(DDRB, PORTB, PORTB, AUXLED_PIN);
+        #endif
+        #ifdef AUXLED2_PIN
+        sim_aux(DDRB, PORTB, PORTB, AUXLED2_PIN);
+        #endif
+        #ifdef AUXLED_RGB_PORT
+        #ifdef AUXLED_RGB_PUE
+        #define SIM_RGB_PUE AUXLED_RGB_PUE
+        #else
+        #define SIM_RGB_PUE AUXLED_RGB_PORT
+        #endif
+        sim_aux(AUXLED_RGB_DDR, SIM_RGB_PUE, AUXLED_RGB_PORT, AUXLED_R_PIN);
+        sim_aux(AUXLED_RGB_DDR, SIM_RGB_PUE, AUXLED_RGB_PORT, AUXLED_G_PIN);
+        sim_aux(AUXLED_RGB_DDR, SIM_RGB_PUE, AUXLED_RGB_PORT, AUXLED_B_PIN);
+        #endif
+    #endif
+    #ifdef USE_RAMPING
+    out->level = actual_level;
+    #endif
+}
+
+
+void sim_fw_internals(SimInternals *in) {
+    in->stack_len = state_stack_len;
+    in->stack_size = STATE_STACK_SIZE;
+    in->queue_len = (uint8_t)(emissions_tail - emissions_head);
+    in->queue_size = EMISSION_QUEUE_LEN;
+    in->queue_overflows = emission_overflows;
+    #ifdef USE_RAMPING
+    in->level = actual_level;
+    in->max_level = MAX_LEVEL;
+    #endif
+    // Anduril's UI states
+    #ifdef OFF_MODE_H
+    in->off = (current_state == off_state);
+    #endif
+    #ifdef LOCKOUT_MODE_H
+    in->off |= (current_state == lockout_state);
+    #endif
+    #ifdef RAMP_MODE_H
+    in->steady = (current_state == steady_state);
+    #endif
+    #ifdef USE_LVP
+    // same test as ADC_voltage_handler()
+    #ifdef DUAL_VOLTAGE_FLOOR
+    in->lvp = ((voltage < VOLTAGE_LOW) && (voltage > DUAL_VOLTAGE_FLOOR))
+              || (voltage < DUAL_VOLTAGE_LOW_LOW);
+    #else
+    in->lvp = (voltage < VOLTAGE_LOW);
+    #endif
+    #endif
+    #ifdef USE_ADAPTIVE_RELEASE_TIMEOUT
+    in->release_timeout = release_timeout;
+    in->release_floor = RELEASE_TIMEOUT_FLOOR;
+    in->release_ceil = RELEASE_TIMEOUT_CEIL;
+    #endif
+    #ifdef USE_THERMAL_REGULATION
+    in->therm_ceil = therm_ceil;
+    in->temperature = temperature;
+    #ifdef MIN_THERM_STEPDOWN
+    in->therm_floor = MIN_THERM_STEPDOWN;
+    #endif
+    #endif
+}
@@ -0,0 +1,106 @@
+/*
+ * sim-run.c: Runs simulated button presses on an FSM program.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Usage:  anduril.NAME.sim [-t|-g] [script ...]
+//   -t  print the outputs every time they change
+//   -g  same, but only what's visible outside the MCU  (no ramp level),
+//       in a shorter format, for golden traces  (see golden.py)
+// Reads a script from each file (or "-" for stdin, which is the default).
+// See sim-script.h for the commands.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "sim-script.h"
+
+static SimOutputs last;
+
+static void trace_hook(uint64_t dt) {
+    SimOutputs o;
+    (void)dt;
+    sim_outputs(&o);
+    if (memcmp(&o, &last, sizeof(o))) {
+        sim_show(&o);
+        last = o;
+    }
+}
+
+static void golden_hook(uint64_t dt) {
+    static uint8_t overflows, release_timeout;
+    SimOutputs o;
+    SimInternals in;
+    (void)dt;
+    // (invisible from outside, but it means an event got dropped)
+    sim_internals(&in);
+    if (in.queue_overflows != overflows) {
+        printf("%.3f emission queue overflowed (%d)\n",
+               sim_now / 1e12, in.queue_overflows);
+        overflows = in.queue_overflows;
+    }
+    // (so click timing changes show up, and whether it stays in range)
+    if (in.release_timeout != release_timeout) {
+        printf("%.3f release timeout %d  (%d to %d)\n", sim_now / 1e12,
+               in.release_timeout, in.release_floor, in.release_ceil);
+        release_timeout = in.release_timeout;
+    }
+    sim_outputs(&o);
+    o.level = last.level;  // internal, so a refactor can change it
+    if (memcmp(&o, &last, sizeof(o))) {
+        printf("%.3f", sim_now / 1e12);
+        for (uint8_t i=0; i<o.channels; i++)
+            printf(" %d/%d", o.pwm[i], o.top[i]);
+        printf(" port %02x%02x%02x ddr %02x%02x%02x aux %d/%d\n",
+               o.port[0], o.port[1], o.port[2],
+               o.ddr[0], o.ddr[1], o.ddr[2], o.aux_high, o.aux_low);
+        last = o;
+    }
+}
+
+int main(int argc, char **argv) {
+    int scripts = 0;
+    clock_t start = clock();
+    double wall;
+
+    sim_power_on();
+    for (int i=1; i<argc; i++) {
+        if (! strcmp(argv[i], "-t")) {
+            sim_hook = trace_hook;
+            continue;
+        }
+        if (! strcmp(argv[i], "-g")) {
+            sim_hook = golden_hook;
+            continue;
+        }
+        FILE *f = strcmp(argv[i], "-") ? fopen(argv[i], "r") : stdin;
+        if (! f) { perror(argv[i]); return 1; }
+        sim_script(f);
+        if (f != stdin) fclose(f);
+        scripts ++;
+    }
+    if (! scripts) sim_script(stdin);
+
+    wall = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("# %s: %.3f s simulated in %.3f s  (%.0fx)\n",
+           sim_fw_config, sim_now / 1e12, wall,
+           wall > 0 ? (sim_now / 1e12) / wall : 0);
+    printf("# %u interrupts, %u eeprom writes, %u resets\n",
+           sim_isrs, sim_eeprom_writes, sim_resets);
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * sim-script.c: Script commands for simulator drivers.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sim-script.h"
+
+uint8_t (*sim_script_ext)(const char *cmd, FILE *f);
+
+void sim_show(SimOutputs *o) {
+    printf("%10.3f s  level %3d  pwm", sim_now / 1e12, o->level);
+    for (uint8_t i=0; i<o->channels; i++)
+        printf(" %4d/%-4d", o->pwm[i], o->top[i]);
+    printf("  port %02x %02x %02x\n", o->port[0], o->port[1], o->port[2]);
+}
+
+uint64_t sim_parse_time(const char *s) {
+    char *end;
+    double t = strtod(s, &end);
+    if (! strcmp(end, "s")) t *= 1000;
+    else if (! strcmp(end, "m")) t *= 60*1000;
+    else if (! strcmp(end, "h")) t *= 60*60*1000;
+    else if (! strcmp(end, "d")) t *= 24*60*60*1000;
+    else if (strcmp(end, "ms") && *end) {
+        fprintf(stderr, "bad time: %s\n", s);
+        exit(1);
+    }
+    return (uint64_t)(t * SIM_PS_PER_MS);
+}
+
+static char word[64];
+static uint8_t word_again;  // next_word() returns the same word again
+
+static const char *next_word(FILE *f) {
+    int c;
+    uint8_t len = 0;
+    if (word_again) {
+        word_again = 0;
+        return word;
+    }
+    while ((c = getc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = getc(f)) != EOF && c != '\n') {}
+        }
+        if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == EOF)) {
+            if (len) break;
+            continue;
+        }
+        if (len < sizeof(word)-1) word[len++] = c;
+    }
+    word[len] = 0;
+    return len ? word : NULL;
+}
+
+const char *sim_script_arg(FILE *f, const char *cmd) {
+    const char *w = next_word(f);
+    if (! w) {
+        fprintf(stderr, "%s: missing argument\n", cmd);
+        exit(1);
+    }
+    return w;
+}
+
+void sim_script(FILE *f) {
+    const char *w;
+    while ((w = next_word(f))) {
+        if (! strcmp(w, "press")) sim_button(1);
+        else if (! strcmp(w, "release")) sim_button(0);
+        else if (! strcmp(w, "wait")) sim_run(sim_parse_time(sim_script_arg(f, w)));
+        else if (! strcmp(w, "click")) {
+            int n = 1;
+            const char *a = next_word(f);
+            // (count is optional)
+            if (a && (a[0] >= '0') && (a[0] <= '9')) n = atoi(a);
+            else if (a) word_again = 1;
+            for (int i=0; i<n; i++) {
+                if (i) sim_run_ms(CLICK_MS);
+                sim_button(1);
+                sim_run_ms(CLICK_MS);
+                sim_button(0);
+            }
+        }
+        else if (! strcmp(w, "hold")) {
+            uint64_t t = sim_parse_time(sim_script_arg(f, w));
+            sim_button(1);
+            sim_run(t);
+            sim_button(0);
+        }
+        else if (! strcmp(w, "volts")) sim_volts = atof(sim_script_arg(f, w));
+        else if (! strcmp(w, "temp")) sim_celsius = atof(sim_script_arg(f, w));
+        else if (! strcmp(w, "poweron")) sim_power_on();
+        else if (! strcmp(w, "dump")) {
+            const char *path = sim_script_arg(f, w);
+            FILE *out = fopen(path, "wb");
+            if (! out) { perror(path); exit(1); }
+            fwrite(sim_eeprom, 1, sim_eeprom_size, out);
+            fclose(out);
+        }
+        else if (! strcmp(w, "show")) {
+            SimOutputs o;
+            sim_outputs(&o);
+            sim_show(&o);
+        }
+        else if (! (sim_script_ext && sim_script_ext(w, f))) {
+            fprintf(stderr, "unknown command: %s\n", w);
+            exit(1);
+        }
+        if (sim_halted) {
+            fprintf(stderr, "main() returned\n");
+            exit(1);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * sim-script.h: Script commands for simulator drivers.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_SCRIPT_H
+#define SIM_SCRIPT_H
+
+#include <stdio.h>
+#include "sim.h"
+
+// A script is a list of commands, separated by spaces or newlines:
+//   press / release   change the button state
+//   wait T            let time pass
+//   click [N]         N quick clicks  (default 1), then let go
+//   hold T            press for T, then release
+//   volts V           set the battery voltage
+//   temp C            set the MCU temperature
+//   poweron           disconnect and reconnect the battery
+//   show              print the current outputs
+//   dump FILE         save the eeprom  (raw, like avrdude's ":r" format)
+//   # ...             comment, until the end of the line
+// Times are in ms by default, or use a suffix:  500ms 2s 5m 1h 7d
+
+#define CLICK_MS 40  // press or release time for quick clicks
+
+// run every command in a file
+void sim_script(FILE *f);
+
+// drivers can add their own commands;  return 0 if it's not one
+extern uint8_t (*sim_script_ext)(const char *cmd, FILE *f);
+// ... and use this to get each argument
+const char *sim_script_arg(FILE *f, const char *cmd);
+
+uint64_t sim_parse_time(const char *s);  // in picoseconds
+void sim_show(SimOutputs *o);  // print one line about the outputs
+
+#endif
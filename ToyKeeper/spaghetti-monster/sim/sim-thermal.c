@@ -0,0 +1,203 @@
+/*
+ * sim-thermal.c: Runs an FSM program's thermal regulation against a
+ *                simple model of the light's body heating up.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Usage:  SIM_DRIVER=../sim/sim-thermal.c ../sim/build.sh anduril cfg-foo.h
+//         anduril.foo.sim [name=value ...] script ...
+// The name=value args describe the light:
+//   pwm1=20:3300  heat (W) and light (lm) at 100% duty, for each output
+//   mass=70       J/C, for the whole body  (aluminum is about 0.9 J/g/C)
+//   conv=0.3      W/C, lost to the air
+//   lag=4         seconds for the MCU's sensor to catch up to the body
+//   ambient=25    C
+// It's one lump of metal:  the LEDs heat it, the air cools it, and the
+// MCU sees its temperature a few seconds late.  That's crude, but it has
+// the parts which make a regulator overshoot or oscillate, and the real
+// firmware's regulator runs against it.
+//
+// Scripts use the same commands as sim-run.c (except "temp", since the
+// model sets the temperature now), plus:
+//   measure    start measuring here, at the level the user picked
+// At the end, it prints how the regulator did, like:
+//   thermal CEIL PEAK OVERSHOOT SETTLE_S OSCILLATION LUMENS LOST_PCT
+// ... where CEIL is the firmware's limit (0 if it has none), PEAK is the hottest the body
+// got, SETTLE_S is how long until it stayed within SETTLE_BAND of where
+// it ended up, OSCILLATION is half the peak-to-peak swing after that,
+// and LOST_PCT is how much light regulation took away from the level
+// which was on at "measure".
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "sim-script.h"
+
+#define SETTLE_BAND 2.0  // C
+#define MAX_STEP 0.05    // seconds per integration step
+#define SAMPLE_MS 1000   // how often to record the temperature
+
+#define MAX_MODEL 16
+static struct { char name[16]; double watts, lumens; } model[MAX_MODEL];
+static uint8_t model_len;
+static double mass = 70, conv = 0.3, lag = 4, ambient = 25;
+
+static double body, sensor;  // C
+
+// since "measure"
+static uint8_t measuring;
+static double seconds, peak, lumen_s, wanted;
+static double *history;  // body temperature, every SAMPLE_MS
+static uint32_t history_len, history_size;
+static double next_sample;
+
+static void output_power(double *watts, double *lumens) {
+    SimOutputs o;
+    *watts = *lumens = 0;
+    sim_outputs(&o);
+    for (uint8_t i=0; i<o.channels; i++) {
+        if (! o.top[i]) continue;
+        for (uint8_t j=0; j<model_len; j++) {
+            if (strcmp(model[j].name, o.name[i])) continue;
+            *watts += model[j].watts * o.pwm[i] / o.top[i];
+            *lumens += model[j].lumens * o.pwm[i] / o.top[i];
+        }
+    }
+}
+
+static void record(double t) {
+    if (history_len >= history_size) {
+        history_size = history_size ? history_size * 2 : 4096;
+        history = realloc(history, history_size * sizeof(*history));
+        if (! history) { perror("realloc"); exit(1); }
+    }
+    history[history_len++] = t;
+}
+
+static void thermal_hook(uint64_t dt) {
+    double watts, lumens;
+    double s = dt / 1e12;
+    output_power(&watts, &lumens);
+    while (s > 0) {
+        double step = s < MAX_STEP ? s : MAX_STEP;
+        body += (watts - (conv * (body - ambient))) * step / mass;
+        sensor += (body - sensor) * step / (lag > step ? lag : step);
+        s -= step;
+        if (! measuring) continue;
+        seconds += step;
+        lumen_s += lumens * step;
+        if (body > peak) peak = body;
+        if (seconds >= next_sample) {
+            record(body);
+            next_sample += SAMPLE_MS / 1000.0;
+        }
+    }
+    sim_celsius = sensor;
+}
+
+static uint8_t thermal_cmd(const char *cmd, FILE *f) {
+    double watts;
+    if (! strcmp(cmd, "temp")) {
+        fprintf(stderr, "temp: the thermal model sets the temperature\n");
+        exit(1);
+    }
+    if (! strcmp(cmd, "ambient")) {
+        ambient = atof(sim_script_arg(f, cmd));
+        return 1;
+    }
+    if (strcmp(cmd, "measure")) return 0;
+    measuring = 1;
+    seconds = lumen_s = 0;
+    peak = body;
+    history_len = 0;
+    next_sample = 0;
+    output_power(&watts, &wanted);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    int scripts = 0;
+    SimInternals in;
+    double final = 0, hi, lo, settle = 0, lumens, lost = 0;
+    uint32_t tail;
+
+    sim_hook = thermal_hook;
+    sim_script_ext = thermal_cmd;
+    for (int i=1; i<argc; i++) {
+        char *eq = strchr(argv[i], '=');
+        if (eq) {
+            double value = atof(eq + 1);
+            char *colon = strchr(eq + 1, ':');
+            *eq = 0;
+            if (! strcmp(argv[i], "mass")) mass = value;
+            else if (! strcmp(argv[i], "conv")) conv = value;
+            else if (! strcmp(argv[i], "lag")) lag = value;
+            else if (! strcmp(argv[i], "ambient")) ambient = value;
+            else if (model_len < MAX_MODEL) {
+                strncpy(model[model_len].name, argv[i], sizeof(model[0].name)-1);
+                model[model_len].watts = value;
+                model[model_len++].lumens = colon ? atof(colon + 1) : 0;
+            }
+            continue;
+        }
+        if (! scripts) {
+            body = sensor = sim_celsius = ambient;
+            sim_power_on();
+        }
+        FILE *f = strcmp(argv[i], "-") ? fopen(argv[i], "r") : stdin;
+        if (! f) { perror(argv[i]); return 1; }
+        sim_script(f);
+        if (f != stdin) fclose(f);
+        scripts ++;
+    }
+    if (! scripts) {
+        body = sensor = sim_celsius = ambient;
+        sim_power_on();
+        sim_script(stdin);
+    }
+    sim_internals(&in);
+
+    if (! history_len) record(body);
+    // where it ended up:  the average over the last quarter
+    tail = history_len - (history_len / 4);
+    for (uint32_t i=tail; i<history_len; i++) final += history[i];
+    final /= history_len - tail;
+    // ... when it got there
+    for (uint32_t i=0; i<history_len; i++)
+        if ((history[i] > final + SETTLE_BAND) || (history[i] < final - SETTLE_BAND))
+            settle = (i + 1) * (SAMPLE_MS / 1000.0);
+    // ... and how much it swings around after that
+    hi = lo = history[history_len - 1];
+    for (uint32_t i=(uint32_t)(settle * 1000 / SAMPLE_MS); i<history_len; i++) {
+        if (history[i] > hi) hi = history[i];
+        if (history[i] < lo) lo = history[i];
+    }
+
+    if (seconds <= 0) seconds = 1e-12;
+    lumens = lumen_s / seconds;
+    if (wanted > 0) lost = 100 * (1 - (lumens / wanted));
+    if (lost < 0) lost = 0;  // (it went brighter, or rounding)
+    printf("# %s: %.0f s, limit %i C, peak %.1f C, settled at %.1f C after %.0f s\n",
+           sim_fw_config, seconds, in.therm_ceil, peak, final, settle);
+    printf("#   %.0f lm on average, out of %.0f lm  (%.1f%% lost)\n",
+           lumens, wanted, lost);
+    printf("thermal %i %.2f %.2f %.0f %.2f %.1f %.2f\n", in.therm_ceil,
+           peak, (in.therm_ceil && (peak > in.therm_ceil)) ? peak - in.therm_ceil : 0,
+           settle, (hi - lo) / 2, lumens, lost);
+    return 0;
+}
@@ -0,0 +1,662 @@
+/*
+ * sim.c: Simulated MCU for host builds of SpaghettiMonster firmware.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The firmware runs on its own stack (a ucontext), and the driver runs
+// on the normal one.  The firmware gives control back whenever simulated
+// time reaches the end of sim_run(), which can only happen at a point
+// where time passes:  sleep, delays, sei(), pin polling, eeprom writes.
+//
+// Peripherals are modeled only as far as FSM uses them:
+//   - WDT (or RTC PIT on xmega) periodic interrupts and reset mode
+//   - ADC single / auto-trigger conversions, with values from sim-fw.c
+//   - the button's pin change interrupt
+//   - CPU clock prescaler  (CLKPR, or CLKCTRL.MCLKCTRLB on xmega)
+//   - sleep modes  (ADC stops in power-down)
+//   - eeprom, which survives resets and power-on
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "sim.h"
+
+#if (ATTINY == 25) || (ATTINY == 45) || (ATTINY == 85) || (ATTINY == 1634)
+#define SIM_CLASSIC
+#if (ATTINY == 1634)
+#define WDT_REG WDTCSR
+#define ADLAR_REG ADCSRB
+#else
+#define WDT_REG WDTCR
+#define ADLAR_REG ADMUX
+#endif
+#else
+#define SIM_XMEGA3
+#endif
+
+// rough costs, in CPU cycles
+#ifndef SIM_SEI_CYCLES
+#define SIM_SEI_CYCLES 100  // code between interrupt-enabled points
+#endif
+#ifndef SIM_ISR_CYCLES
+#define SIM_ISR_CYCLES 30
+#endif
+#define SIM_PIN_CYCLES 4  // one pass of a "while (pin) {}" loop
+#define SIM_EEPROM_WRITE_PS (3400ULL * SIM_PS_PER_US)
+#define SIM_FOREVER (~0ULL >> 1)
+
+#ifndef SIM_STACK_SIZE
+#define SIM_STACK_SIZE (256*1024)
+#endif
+
+// registers
+volatile uint8_t sim_io[SIM_IO_SIZE];
+#ifdef SIM_XMEGA3
+PORT_t sim_PORT[3];
+VPORT_t sim_VPORT[3];
+ADC_t sim_ADC0;
+RTC_t sim_RTC;
+TCA_t sim_TCA0;
+CLKCTRL_t sim_CLKCTRL;
+RSTCTRL_t sim_RSTCTRL;
+WDT_t sim_WDT;
+VREF_t sim_VREF;
+DAC_t sim_DAC0;
+SIGROW_t sim_SIGROW;
+PORTMUX_t sim_PORTMUX;
+// last values synced between PORT and VPORT
+static uint8_t port_dir[3], port_out[3];
+// last values copied from TCA0's buffer registers
+static uint16_t tca_buf[4];
+#endif
+
+// public state
+uint64_t sim_now;
+double sim_volts = 4.0;
+double sim_celsius = 25.0;
+uint8_t sim_button_state;
+uint8_t sim_halted;
+SimCpu sim_cpu;
+void (*sim_hook)(uint64_t dt);
+uint8_t sim_eeprom[E2END+1];
+const uint16_t sim_eeprom_size = E2END+1;
+uint32_t sim_eeprom_writes;
+uint32_t sim_resets;
+uint32_t sim_isrs;
+uint8_t sim_sleep_mode;
+uint8_t sim_sleep_enabled;
+
+// firmware RAM, renamed by sim/build.sh so it can be reset
+extern char __start_fw_data[] __attribute__ ((weak));
+extern char __stop_fw_data[] __attribute__ ((weak));
+extern char __start_fw_bss[] __attribute__ ((weak));
+extern char __stop_fw_bss[] __attribute__ ((weak));
+extern char __start_fw_noinit[] __attribute__ ((weak));
+extern char __stop_fw_noinit[] __attribute__ ((weak));
+static char *fw_data_image;
+
+// execution
+static ucontext_t driver_ctx, fw_ctx;
+static char *fw_stack;
+static uint8_t in_fw;      // running firmware code?
+static uint8_t in_isr;
+static uint8_t powered;
+static uint8_t reset_request;  // reset flags, or 0
+static uint64_t stop_at;   // end of the current sim_run()
+static uint64_t debt;      // time used by ISRs, paid at the next advance()
+static uint16_t spin;      // pin reads in a row, with nothing else between
+
+// peripherals
+static uint64_t cycle_ps;  // one CPU cycle
+static uint8_t wdt_cfg;
+static uint64_t wdt_period, wdt_next;  // periodic interrupt
+#ifdef SIM_XMEGA3
+static uint64_t wdr_next;  // watchdog reset  (0 = off)
+#endif
+static uint8_t wdt_flag, adc_flag, pin_flag;  // interrupts pending
+static uint8_t adc_busy, adc_first;
+static uint64_t adc_done;
+
+static void yield_to_driver(void);
+
+
+//////////  peripherals  //////////
+
+static void adc_start(void) {
+    uint16_t cycles;
+    #ifdef SIM_CLASSIC
+    uint8_t presc = ADCSRA & 0x07;
+    cycles = presc ? (1 << presc) : 2;
+    #else
+    cycles = 2 << (ADC0.CTRLC & ADC_PRESC_gm);
+    #endif
+    cycles *= adc_first ? 25 : 13;
+    adc_first = 0;
+    adc_busy = 1;
+    adc_done = sim_now + (cycles * cycle_ps);
+}
+
+static void adc_complete(void) {
+    uint16_t raw = sim_fw_adc();
+    #ifdef SIM_CLASSIC
+    if (ADLAR_REG & (1 << ADLAR)) raw <<= 6;
+    ADC = raw;
+    ADCSRA |= (1 << ADIF);
+    adc_flag = 1;
+    // auto-trigger in free running mode
+    if ((ADCSRA & (1 << ADATE)) && (! (ADCSRB & 0x07))) adc_start();
+    else { ADCSRA &= ~(1 << ADSC); adc_busy = 0; }
+    #else
+    ADC0.RES = raw;
+    ADC0.INTFLAGS |= ADC_RESRDY_bm;
+    adc_flag = 1;
+    if (ADC0.CTRLA & ADC_FREERUN_bm) adc_start();
+    else { ADC0.COMMAND &= ~ADC_STCONV_bm; adc_busy = 0; }
+    #endif
+}
+
+// notice what the firmware changed since last time
+static void sync(void) {
+    uint64_t period = 0;
+    uint8_t cfg;
+
+    #ifdef SIM_CLASSIC
+    // clock prescaler
+    cycle_ps = (1000000000000ULL / sim_fw_f_cpu) << (CLKPR & 0x0F);
+
+    // watchdog
+    WDT_REG &= ~(1 << WDIF);  // (the real flag is wdt_flag)
+    cfg = WDT_REG & 0x6F;  // WDIE, WDE, WDP
+    if (cfg & ((1 << WDIE) | (1 << WDE))) {
+        uint8_t wdp = (cfg & 0x07) | ((cfg >> 2) & 0x08);
+        period = (16ULL * SIM_PS_PER_MS) << wdp;
+    }
+
+    // ADC
+    if (! (ADCSRA & (1 << ADEN))) { adc_busy = 0; adc_first = 1; }
+    else if ((ADCSRA & (1 << ADSC)) && (! adc_busy)) adc_start();
+    sim_cpu.adc_on = (ADCSRA >> ADEN) & 1;
+
+    #else
+    // clock prescaler  (base clock is 20 MHz, F_CPU assumes PDIV 2X)
+    {
+        static const uint8_t pdiv[16] = {
+            2, 4, 8, 16, 32, 64, 1, 1, 6, 10, 12, 24, 48, 1, 1, 1 };
+        uint8_t b = CLKCTRL.MCLKCTRLB;
+        uint8_t div = (b & CLKCTRL_PEN_bm) ? pdiv[(b >> 1) & 0x0F] : 1;
+        cycle_ps = (500000000000ULL / sim_fw_f_cpu) * div;
+    }
+
+    // periodic interrupt timer  (period n is 2^(n+1) cycles of 32768 Hz)
+    cfg = RTC.PITCTRLA;
+    if ((cfg & RTC_PITEN_bm) && (cfg & RTC_PERIOD_gm)) {
+        uint8_t n = (cfg & RTC_PERIOD_gm) >> 3;
+        period = (1000000000000ULL << (n + 1)) / 32768;
+    }
+    RTC.PITSTATUS = 0;
+    CLKCTRL.MCLKSTATUS = 0;
+    if (! (WDT.CTRLA & WDT_PERIOD_gm)) wdr_next = 0;
+
+    // ADC
+    if (! (ADC0.CTRLA & ADC_ENABLE_bm)) { adc_busy = 0; adc_first = 1; }
+    else if ((ADC0.COMMAND & ADC_STCONV_bm) && (! adc_busy)) adc_start();
+    sim_cpu.adc_on = ADC0.CTRLA & ADC_ENABLE_bm;
+
+    // buffered timer registers  (copied right away, not at the next TOP)
+    {
+        TCA_SINGLE_t *t = &TCA0.SINGLE;
+        if (t->PERBUF != tca_buf[0]) t->PER = tca_buf[0] = t->PERBUF;
+        if (t->CMP0BUF != tca_buf[1]) t->CMP0 = tca_buf[1] = t->CMP0BUF;
+        if (t->CMP1BUF != tca_buf[2]) t->CMP1 = tca_buf[2] = t->CMP1BUF;
+        if (t->CMP2BUF != tca_buf[3]) t->CMP2 = tca_buf[3] = t->CMP2BUF;
+    }
+
+    // pins:  apply strobe registers, and keep PORT and VPORT in sync
+    for (uint8_t i=0; i<3; i++) {
+        PORT_t *p = &sim_PORT[i];
+        VPORT_t *v = &sim_VPORT[i];
+        if (v->DIR != port_dir[i]) p->DIR = v->DIR;
+        if (v->OUT != port_out[i]) p->OUT = v->OUT;
+        p->DIR = (p->DIR | p->DIRSET) & ~p->DIRCLR;
+        p->DIR ^= p->DIRTGL;
+        p->OUT = (p->OUT | p->OUTSET) & ~p->OUTCLR;
+        p->OUT ^= p->OUTTGL;
+        p->DIRSET = p->DIRCLR = p->DIRTGL = 0;
+        p->OUTSET = p->OUTCLR = p->OUTTGL = 0;
+        v->DIR = port_dir[i] = p->DIR;
+        v->OUT = port_out[i] = p->OUT;
+        p->IN = v->IN;
+        // (writing 1 clears the flag)
+        p->INTFLAGS = v->INTFLAGS = 0;
+    }
+    #endif
+
+    // (re)start the periodic interrupt
+    if (cfg != wdt_cfg) {
+        if (! wdt_period) wdt_next = sim_now + period;
+        else wdt_next = wdt_next - wdt_period + period;
+        // (a shorter period which has already run out fires right away)
+        if (wdt_next < sim_now) wdt_next = sim_now;
+        wdt_cfg = cfg;
+        wdt_period = period;
+    }
+    sim_cpu.wdt_on = (period != 0);
+    sim_cpu.hz = 1000000000000ULL / cycle_ps;
+}
+
+static void request_reset(uint8_t flags) {
+    reset_request = flags;
+    yield_to_driver();  // ... and never come back
+}
+
+// handle whatever happens at exactly sim_now
+static void fire_events(void) {
+    if (wdt_period && (wdt_next <= sim_now)) {
+        wdt_next = sim_now + wdt_period;
+        #ifdef SIM_CLASSIC
+        uint8_t cfg = WDT_REG;
+        if (cfg & (1 << WDIE)) {
+            wdt_flag = 1;
+            // interrupt + reset mode:  the next timeout resets
+            if (cfg & (1 << WDE)) WDT_REG = wdt_cfg = cfg & ~(1 << WDIE);
+        }
+        else request_reset(1 << WDRF);
+        #else
+        RTC.PITINTFLAGS |= RTC_PI_bm;
+        wdt_flag = 1;
+        #endif
+    }
+    #ifdef SIM_XMEGA3
+    if (wdr_next && (wdr_next <= sim_now)) request_reset(RSTCTRL_WDRF_bm);
+    #endif
+    if (adc_busy && (adc_done <= sim_now)) adc_complete();
+}
+
+
+//////////  interrupts  //////////
+
+typedef void (*Vector)(void);
+
+static void call_isr(Vector vect) {
+    if (! vect) return;
+    SREG &= ~(1 << SIM_SREG_I);
+    in_isr = 1;
+    sim_isrs ++;
+    vect();
+    in_isr = 0;
+    SREG |= (1 << SIM_SREG_I);
+    debt += SIM_ISR_CYCLES * cycle_ps;
+}
+
+static uint8_t button_pending(void) {
+    return pin_flag && sim_fw_button_irq_enabled();
+}
+
+static uint8_t wdt_pending(void) {
+    #ifdef SIM_CLASSIC
+    return wdt_flag;
+    #else
+    return wdt_flag && (RTC.PITINTCTRL & RTC_PI_bm);
+    #endif
+}
+
+static uint8_t adc_pending(void) {
+    #ifdef SIM_CLASSIC
+    return adc_flag && (ADCSRA & (1 << ADIE));
+    #else
+    return adc_flag && (ADC0.INTCTRL & ADC_RESRDY_bm);
+    #endif
+}
+
+static uint8_t irq_pending(void) {
+    return button_pending() || wdt_pending() || adc_pending();
+}
+
+static void fire_wdt(void) {
+    wdt_flag = 0;
+    #ifdef SIM_CLASSIC
+    call_isr(WDT_vect);
+    #else
+    call_isr(RTC_PIT_vect);
+    #endif
+}
+
+static void fire_adc(void) {
+    adc_flag = 0;
+    #ifdef SIM_CLASSIC
+    ADCSRA &= ~(1 << ADIF);
+    call_isr(ADC_vect);
+    #else
+    call_isr(ADC0_RESRDY_vect);
+    #endif
+}
+
+// run pending interrupts, in the MCU's priority order
+static void deliver(void) {
+    if (in_isr) return;
+    while (SREG & (1 << SIM_SREG_I)) {
+        if (button_pending()) {
+            pin_flag = 0;
+            call_isr(sim_fw_button_isr);
+        }
+        #if (ATTINY == 1634) || defined(SIM_XMEGA3)
+        else if (wdt_pending()) fire_wdt();
+        else if (adc_pending()) fire_adc();
+        #else
+        else if (adc_pending()) fire_adc();
+        else if (wdt_pending()) fire_wdt();
+        #endif
+        else break;
+    }
+}
+
+
+//////////  time  //////////
+
+static void pass_time(uint64_t dt, uint8_t asleep) {
+    if (! dt) return;
+    sim_cpu.asleep = asleep;
+    sim_cpu.sleep_mode = asleep ? sim_sleep_mode : 0;
+    // ADC clock stops in power-down
+    if (asleep && adc_busy && (sim_sleep_mode == SLEEP_MODE_PWR_DOWN))
+        adc_done += dt;
+    if (sim_hook) sim_hook(dt);
+    sim_now += dt;
+    sim_cpu.asleep = 0;
+}
+
+// Let time pass, either busy (for ps picoseconds) or asleep (until an
+// interrupt wakes the MCU).  Interrupts run as they come due.
+static void advance(uint64_t ps, uint8_t asleep) {
+    uint64_t until;
+    uint32_t isrs = sim_isrs;
+
+    if (! in_fw) return;  // the driver poking at registers
+    spin = 0;
+    ps += debt;
+    debt = 0;
+    until = sim_now + ps;
+
+    while (1) {
+        uint64_t next;
+        sync();
+        deliver();
+        if (asleep) {
+            if (sim_isrs != isrs) break;
+            // (wakes up, but can't run the ISR)
+            if ((! (SREG & (1 << SIM_SREG_I))) && irq_pending()) break;
+        }
+        else if (sim_now >= until) break;
+        if (sim_now >= stop_at) {
+            yield_to_driver();
+            continue;
+        }
+        next = stop_at;
+        if ((! asleep) && (until < next)) next = until;
+        if (wdt_period && (wdt_next < next)) next = wdt_next;
+        #ifdef SIM_XMEGA3
+        if (wdr_next && (wdr_next < next)) next = wdr_next;
+        #endif
+        if (adc_busy && (adc_done < next) && (! (asleep
+                && (sim_sleep_mode == SLEEP_MODE_PWR_DOWN))))
+            next = adc_done;
+        pass_time(next - sim_now, asleep);
+        fire_events();
+    }
+}
+
+
+//////////  hooks for the fake avr-libc  //////////
+
+// Polling a pin in a tight loop would run at about real-time speed, so
+// each read in a row takes longer than the last.  (this only skews code
+// which counts loop passes instead of using delays or ticks)
+static void pin_read(void) {
+    uint16_t s;
+    if (in_isr || (! in_fw)) return;
+    s = spin + 1;
+    advance((SIM_PIN_CYCLES * cycle_ps) << ((s >> 6) < 12 ? (s >> 6) : 12), 0);
+    spin = s;
+}
+
+volatile uint8_t *sim_pin(uint8_t addr) {
+    pin_read();
+    return &sim_io[addr];
+}
+
+#ifdef SIM_XMEGA3
+VPORT_t *sim_vport(uint8_t n) {
+    pin_read();
+    return &sim_VPORT[n];
+}
+#endif
+
+void sim_sei(void) {
+    SREG |= (1 << SIM_SREG_I);
+    if (! in_isr) advance(SIM_SEI_CYCLES * cycle_ps, 0);
+}
+
+void sim_cli(void) {
+    SREG &= ~(1 << SIM_SREG_I);
+}
+
+void sim_cpu_cycles(uint32_t cycles) {
+    if (in_isr) debt += cycles * cycle_ps;
+    else {
+        // (delay loops usually come right after a prescaler change)
+        sync();
+        advance(cycles * cycle_ps, 0);
+    }
+}
+
+void sim_sleep_cpu(void) {
+    if (! sim_sleep_enabled) return;
+    advance(0, 1);
+}
+
+void sim_wdt_reset(void) {
+    sync();
+    wdt_next = sim_now + wdt_period;
+    #ifdef SIM_CLASSIC
+    if (! (WDT_REG & (1 << WDE))) return;
+    #else
+    {
+        uint8_t p = WDT.CTRLA & WDT_PERIOD_gm;
+        if (! p) return;
+        wdr_next = sim_now + ((8ULL * SIM_PS_PER_MS) << (p - 1));
+    }
+    #endif
+    // FSM only does this to reboot, so wait for it
+    advance(SIM_FOREVER, 0);
+}
+
+void sim_wdt_disable(void) {
+    #ifdef SIM_CLASSIC
+    WDT_REG = 0;
+    #else
+    WDT.CTRLA = 0;
+    #endif
+}
+
+// not the real program, but bytes which look about as random
+uint8_t sim_flash_byte(uint16_t addr) {
+    uint32_t x = addr * 2654435761u;
+    return x >> 24;
+}
+
+uint8_t sim_eeprom_read(uint16_t addr) {
+    if (addr > E2END) return 0xff;
+    return sim_eeprom[addr];
+}
+
+void sim_eeprom_write(uint16_t addr, uint8_t value) {
+    if (addr > E2END) return;
+    sim_eeprom[addr] = value;
+    sim_eeprom_writes ++;
+    advance(SIM_EEPROM_WRITE_PS, 0);
+}
+
+
+//////////  driver side  //////////
+
+static void fw_entry(void) {
+    in_fw = 1;
+    sim_fw_main();
+    in_fw = 0;
+    sim_halted = 1;
+}
+
+static void yield_to_driver(void) {
+    in_fw = 0;
+    swapcontext(&fw_ctx, &driver_ctx);
+    in_fw = 1;
+}
+
+// like pulling the reset line:  fresh RAM and registers, same eeprom
+static void reset(uint8_t flags, uint8_t power_on) {
+    size_t size;
+
+    // RAM
+    size = __stop_fw_data - __start_fw_data;
+    if (size) memcpy(__start_fw_data, fw_data_image, size);
+    size = __stop_fw_bss - __start_fw_bss;
+    if (size) memset(__start_fw_bss, 0, size);
+    if (power_on) {
+        size = __stop_fw_noinit - __start_fw_noinit;
+        for (size_t i=0; i<size; i++) __start_fw_noinit[i] = rand();
+    }
+
+    // registers
+    #ifdef SIM_CLASSIC
+    {
+        uint8_t mcusr = power_on ? 0 : MCUSR;
+        memset((void *)sim_io, 0, sizeof(sim_io));
+        MCUSR = mcusr | flags;
+    }
+    #else
+    {
+        memset((void *)sim_io, 0, sizeof(sim_io));
+        memset(sim_PORT, 0, sizeof(sim_PORT));
+        memset(sim_VPORT, 0, sizeof(sim_VPORT));
+        memset(port_dir, 0, sizeof(port_dir));
+        memset(port_out, 0, sizeof(port_out));
+        memset(tca_buf, 0, sizeof(tca_buf));
+        memset(&sim_ADC0, 0, sizeof(sim_ADC0));
+        memset(&sim_RTC, 0, sizeof(sim_RTC));
+        memset(&sim_TCA0, 0, sizeof(sim_TCA0));
+        memset(&sim_CLKCTRL, 0, sizeof(sim_CLKCTRL));
+        memset(&sim_WDT, 0, sizeof(sim_WDT));
+        memset(&sim_VREF, 0, sizeof(sim_VREF));
+        memset(&sim_DAC0, 0, sizeof(sim_DAC0));
+        memset(&sim_PORTMUX, 0, sizeof(sim_PORTMUX));
+        // 20 MHz / 6 at boot
+        CLKCTRL.MCLKCTRLB = CLKCTRL_PDIV_6X_gc | CLKCTRL_PEN_bm;
+        // ideal temperature sensor calibration
+        SIGROW.TEMPSENSE0 = 128;
+        SIGROW.TEMPSENSE1 = 0;
+        // (firmware clears these by writing 1s, which the simulator
+        //  can't tell apart from a plain write, so only show the latest)
+        RSTCTRL.RSTFR = flags;
+        wdr_next = 0;
+    }
+    #endif
+    // peripherals
+    wdt_cfg = 0;
+    wdt_period = 0;
+    wdt_flag = adc_flag = pin_flag = 0;
+    adc_busy = 0;
+    adc_first = 1;
+    sim_sleep_mode = sim_sleep_enabled = 0;
+    debt = 0;
+    in_isr = 0;
+    sim_fw_set_button(sim_button_state);
+    sync();
+
+    // start at main()
+    getcontext(&fw_ctx);
+    fw_ctx.uc_stack.ss_sp = fw_stack;
+    fw_ctx.uc_stack.ss_size = SIM_STACK_SIZE;
+    fw_ctx.uc_link = &driver_ctx;
+    makecontext(&fw_ctx, fw_entry, 0);
+    sim_halted = 0;
+}
+
+void sim_power_on(void) {
+    if (! fw_stack) {
+        size_t size = __stop_fw_data - __start_fw_data;
+        fw_stack = malloc(SIM_STACK_SIZE);
+        fw_data_image = malloc(size + 1);
+        if (size) memcpy(fw_data_image, __start_fw_data, size);
+        memset(sim_eeprom, 0xff, sizeof(sim_eeprom));
+        srand(0);
+    }
+    #ifdef SIM_CLASSIC
+    reset(1 << PORF, 1);
+    #else
+    reset(RSTCTRL_PORF_bm, 1);
+    #endif
+    powered = 1;
+}
+
+void sim_run(uint64_t ps) {
+    if (! powered) sim_power_on();
+    stop_at = sim_now + ps;
+    while ((sim_now < stop_at) && (! sim_halted)) {
+        in_fw = 1;
+        swapcontext(&driver_ctx, &fw_ctx);
+        in_fw = 0;
+        if (reset_request) {
+            reset(reset_request, 0);
+            reset_request = 0;
+            sim_resets ++;
+        }
+    }
+}
+
+void sim_button(uint8_t pressed) {
+    pressed = !!pressed;
+    if (pressed == sim_button_state) return;
+    sim_button_state = pressed;
+    if (! powered) return;
+    sim_fw_set_button(pressed);
+    pin_flag = 1;
+}
+
+void sim_outputs(SimOutputs *out) {
+    memset(out, 0, sizeof(*out));
+    #ifdef SIM_CLASSIC
+    #if (ATTINY == 1634)
+    out->port[0] = PORTA;  out->ddr[0] = DDRA;
+    out->port[2] = PORTC;  out->ddr[2] = DDRC;
+    #endif
+    out->port[1] = PORTB;  out->ddr[1] = DDRB;
+    #else
+    for (uint8_t i=0; i<3; i++) {
+        out->port[i] = sim_PORT[i].OUT;
+        out->ddr[i] = sim_PORT[i].DIR;
+    }
+    #endif
+    sim_fw_outputs(out);
+}
+
+void sim_internals(SimInternals *in) {
+    memset(in, 0, sizeof(*in));
+    sim_fw_internals(in);
+}
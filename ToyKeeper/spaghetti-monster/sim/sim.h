@@ -0,0 +1,130 @@
+/*
+ * sim.h: Host-side simulator for SpaghettiMonster firmware.
+ *
+ * Copyright (C) 2017 Selene Scriven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+// This runs a real FSM recipe (like Anduril), compiled with the host's
+// gcc against the fake avr-libc in include/, on top of a simple model of
+// the MCU's peripherals:  WDT / PIT clock ticks, ADC, pin change
+// interrupts, sleep, clock prescaler, eeprom, and watchdog reboots.
+//
+// It is NOT cycle-accurate.  Time passes during delays, sleep, eeprom
+// writes, and a fixed amount per sei(), but regular code takes no time.
+// That's close enough to test UI behavior and power use, and it runs
+// much faster than real time.  (and int is 32 bits here, not 16)
+//
+// A driver program (like sim-run.c) calls these functions to push the
+// button, change the battery voltage or temperature, and let time pass.
+
+#include <stdint.h>
+
+#define SIM_PS_PER_US 1000000ULL
+#define SIM_PS_PER_MS 1000000000ULL
+
+// simulated time since the simulator started, in picoseconds
+extern uint64_t sim_now;
+#define sim_now_ms() (sim_now / SIM_PS_PER_MS)
+
+// the outside world  (drivers can change these any time)
+extern double sim_volts;    // battery voltage, as the light should read it
+extern double sim_celsius;  // MCU temperature
+extern uint8_t sim_button_state;  // 1 = pressed
+
+// running the light
+void sim_power_on(void);    // connect the battery  (eeprom persists)
+void sim_run(uint64_t ps);  // let time pass
+#define sim_run_ms(ms) sim_run((uint64_t)(ms) * SIM_PS_PER_MS)
+void sim_button(uint8_t pressed);
+extern uint8_t sim_halted;  // main() returned?  (shouldn't happen)
+
+// what the light is doing
+#define SIM_MAX_CHANNELS 6
+typedef struct SimOutputs {
+    uint8_t channels;  // PWMn_LVL registers, then TINTn_LVL
+    const char *name[SIM_MAX_CHANNELS];  // "pwm1", "tint1", etc
+    uint16_t pwm[SIM_MAX_CHANNELS];  // output compare values
+    uint16_t top[SIM_MAX_CHANNELS];  // ... out of this many
+    uint8_t level;     // ramp level  (actual_level, if USE_RAMPING)
+    uint8_t port[3];   // PORTA/B/C output registers  (enable pins, aux LEDs)
+    uint8_t ddr[3];    // DDRA/B/C
+    uint8_t aux_high;  // how many aux LEDs are on high
+    uint8_t aux_low;   // ... or low  (pull-up only)
+} SimOutputs;
+void sim_outputs(SimOutputs *out);
+
+// what the firmware is doing inside  (for invariant checks, like in
+// sim-fuzz.c;  anything the program doesn't have is left at 0)
+typedef struct SimInternals {
+    uint8_t stack_len;     // FSM state stack
+    uint8_t stack_size;
+    uint8_t queue_len;     // emission queue
+    uint8_t queue_size;
+    uint8_t queue_overflows;
+    uint8_t level;         // actual_level
+    uint8_t max_level;
+    uint8_t off;           // UI is in off or lockout mode
+    uint8_t steady;        // UI is in the normal ramp mode
+    uint8_t lvp;           // voltage reading is low enough for LVP
+    uint8_t therm_floor;   // regulation doesn't step down below this
+    uint8_t therm_ceil;    // C
+    int16_t temperature;   // C, as the firmware sees it
+    uint8_t release_timeout;  // ticks, if USE_ADAPTIVE_RELEASE_TIMEOUT
+    uint8_t release_floor;    // ... and how far it's allowed to go
+    uint8_t release_ceil;
+} SimInternals;
+void sim_internals(SimInternals *in);
+
+// what the MCU is doing
+typedef struct SimCpu {
+    uint8_t asleep;      // in sleep_cpu()?
+    uint8_t sleep_mode;  // SLEEP_MODE_*, if asleep
+    uint32_t hz;         // CPU clock, after the prescaler
+    uint8_t adc_on;
+    uint8_t wdt_on;      // WDT or PIT ticking
+} SimCpu;
+extern SimCpu sim_cpu;
+
+// called just before simulated time moves forward by dt picoseconds,
+// with sim_cpu and sim_outputs() describing that whole interval
+// (for energy, heat, and battery models)
+extern void (*sim_hook)(uint64_t dt);
+
+// eeprom contents and wear
+extern uint8_t sim_eeprom[];
+extern const uint16_t sim_eeprom_size;
+extern uint32_t sim_eeprom_writes;
+
+// counters
+extern uint32_t sim_resets;  // not counting power-on
+extern uint32_t sim_isrs;
+
+
+// Provided by sim-fw.c, which wraps the firmware  (not for drivers)
+int sim_fw_main();
+extern const uint32_t sim_fw_f_cpu;
+extern const char sim_fw_config[];
+void sim_fw_set_button(uint8_t pressed);
+uint8_t sim_fw_button_irq_enabled(void);
+void sim_fw_button_isr(void);
+uint16_t sim_fw_adc(void);  // 10-bit result for the current ADC channel
+void sim_fw_outputs(SimOutputs *out);
+void sim_fw_internals(SimInternals *in);
+
+#endif
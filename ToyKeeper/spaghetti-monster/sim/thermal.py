@@ -0,0 +1,227 @@
+#!/usr/bin/env python
+
+"""Checks thermal regulation on each build target, in the simulator.
+
+Run it from the program's directory:
+
+    ../sim/thermal.py [options] [pattern]
+
+For each cfg-*.h which matches the pattern, it builds the program with
+sim-thermal.c, runs every scenario in sim/thermal/ against a model of
+the light's body heating up (from sim/thermal-models.txt), and prints
+how the regulator did:  the temperature limit, the peak temperature and
+how far that overshot the limit, how long it took to settle, how much
+it oscillates after that, and the average lumens and percent lost.
+
+Options:
+    --scenario F    run only this script  (can be repeated)
+    --sweep N=A,B   build with each value of macro N  (can be repeated,
+                    to try every combination)
+    -D FOO          build with an extra flag  (or -UFOO;  can be repeated)
+
+For example:
+
+    ../sim/thermal.py --sweep THERM_LOOKAHEAD=2,4,6 \\
+        --sweep THERM_RESPONSE_MAGNITUDE=32,64,128 emisar-d4v2
+
+Swept macros replace whatever the cfg sets, so it works for things like
+THERM_FASTER_LEVEL too.  For each target and scenario, the stable
+settings (overshoot under OVERSHOOT_OK, oscillation under OSCILLATION_OK)
+which lose the least light get a "*".
+"""
+
+from __future__ import print_function
+
+import itertools
+import os
+import re
+import subprocess
+import sys
+
+SIM = os.path.dirname(os.path.abspath(__file__))
+MODELS = os.path.join(SIM, 'thermal-models.txt')
+SEARCH = ['.', '..', '../..', '../../..']
+OVERSHOOT_OK = 3.0  # C
+OSCILLATION_OK = 1.5  # C  (it's regulating to a 2 C window)
+
+
+def main(args):
+    """Build, run, and tabulate each target"""
+    scenarios = []
+    flags = []
+    sweeps = []
+    pattern = ''
+    while args:
+        arg = args.pop(0)
+        if arg == '--scenario':
+            scenarios.append(os.path.abspath(args.pop(0)))
+        elif arg == '--sweep':
+            name, values = args.pop(0).split('=', 1)
+            sweeps.append([(name, v) for v in values.split(',')])
+        elif arg in ('-D', '-U'):
+            flags.append(arg + args.pop(0))
+        elif arg.startswith('-D') or arg.startswith('-U'):
+            flags.append(arg)
+        elif arg in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            pattern = arg
+    if not scenarios:
+        d = os.path.join(SIM, 'thermal')
+        scenarios = [os.path.join(d, f) for f in sorted(os.listdir(d))
+                     if f.endswith('.txt')]
+
+    models = load_models()
+    out = 'thermal-out'
+    if not os.path.isdir(out):
+        os.mkdir(out)
+
+    combos = list(itertools.product(*sweeps))
+    width = max([len('settings')] + [len(settings(c)) for c in combos])
+    print('%-28s %-10s %-*s %5s %6s %5s %6s %5s %6s %6s' % (
+        'target', 'scenario', width, 'settings', 'ceil', 'peak', 'over',
+        'settle', 'osc', 'lm', 'lost%'))
+
+    failed = []
+    for cfg in sorted(os.listdir('.')):
+        if not (cfg.startswith('cfg-') and cfg.endswith('.h')):
+            continue
+        if pattern.lower() not in cfg.lower():
+            continue
+        name = cfg[4:-2]
+        model = find_model(cfg, models)
+        if not model:
+            failed.append(name + ' (no model)')
+            continue
+
+        rows = []
+        for combo in combos:
+            binary = build(cfg, name, out, flags, combo)
+            if not binary:
+                failed.append(name + ' (build)')
+                break
+            for scenario in scenarios:
+                result = simulate(binary, model, scenario)
+                rows.append((name, os.path.basename(scenario)[:-4],
+                             settings(combo), result))
+        rows.sort(key=lambda r: r[1])  # (stable, so combos stay in order)
+        for row in mark_best(rows, width):
+            print(row)
+        sys.stdout.flush()
+
+    if failed:
+        print('Skipped: %s' % ', '.join(failed))
+        return 1
+    return 0
+
+
+def settings(combo):
+    """Describe swept values, without the THERM_ prefix to save space"""
+    text = ' '.join('%s=%s' % (re.sub('^THERM_', '', n), v) for n, v in combo)
+    return text or '-'
+
+
+def mark_best(rows, width):
+    """Format each row, with a * on the best stable one per scenario"""
+    best = {}
+    for name, scenario, desc, r in rows:
+        if not r or not r['ceil']:
+            continue
+        if r['over'] > OVERSHOOT_OK or r['osc'] > OSCILLATION_OK:
+            continue
+        if (scenario not in best) or (r['lost'] < best[scenario]['lost']):
+            best[scenario] = r
+    lines = []
+    for name, scenario, desc, r in rows:
+        if not r:
+            lines.append('%-28s %-10s %-*s %s' % (
+                name, scenario, width, desc, 'error'))
+            continue
+        star = ''
+        if len(rows) > 1 and best.get(scenario) is r:
+            star = ' *'
+        # (no limit means it doesn't have thermal regulation)
+        ceil = r['ceil'] and '%i' % r['ceil'] or '-'
+        lines.append('%-28s %-10s %-*s %5s %6.1f %5.1f %6i %5.2f %6i %6.1f%s' % (
+            name, scenario, width, desc, ceil, r['peak'], r['over'],
+            r['settle'], r['osc'], r['lm'], r['lost'], star))
+    return lines
+
+
+def load_models():
+    """Read thermal-models.txt into {file: [name=value, ...]}"""
+    models = {}
+    for line in open(MODELS):
+        line = line.split('#')[0].split()
+        if line:
+            models[line[0]] = line[1:]
+    return models
+
+
+def find_model(path, models, seen=None):
+    """Follow #includes from a cfg, and return the first model found"""
+    seen = seen or set()
+    if os.path.basename(path) in models:
+        return models[os.path.basename(path)]
+    if path in seen:
+        return None
+    seen.add(path)
+    for line in open(path):
+        m = re.match(r'^\s*#include\s+"([^"]+)"', line)
+        if not m:
+            continue
+        # like gcc:  next to this file first, then the -I dirs
+        dirs = [os.path.dirname(path)] + SEARCH
+        for d in dirs:
+            inc = os.path.normpath(os.path.join(d, m.group(1)))
+            if os.path.exists(inc):
+                found = find_model(inc, models, seen)
+                if found:
+                    return found
+                break
+    return None
+
+
+def build(cfg, name, out, flags, combo):
+    """Build one target with the thermal driver, and any swept values"""
+    if combo:
+        # a cfg which wraps the real one, so it can replace its values
+        wrapper = os.path.join(out, cfg)
+        f = open(wrapper, 'w')
+        for line in open(cfg):
+            if 'ATTINY:' in line:
+                f.write(line)
+        f.write('#include "../%s"\n' % cfg)
+        for macro, value in combo:
+            f.write('#undef %s\n#define %s %s\n' % (macro, macro, value))
+        f.close()
+        cfg = wrapper
+    env = dict(os.environ)
+    env['SIM_DRIVER'] = os.path.join(SIM, 'sim-thermal.c')
+    cmd = [os.path.join(SIM, 'build.sh'), 'anduril', cfg] + flags
+    proc = subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    proc.communicate()
+    if proc.returncode:
+        return None
+    binary = os.path.join(out, 'anduril.%s.sim' % name)
+    os.rename('anduril.%s.sim' % name, binary)
+    return binary
+
+
+def simulate(binary, model, scenario):
+    """Run a scenario, and return its "thermal" line as a dict"""
+    proc = subprocess.Popen([binary] + model + [scenario],
+                            stdout=subprocess.PIPE)
+    text = proc.communicate()[0].decode('utf-8', 'replace')
+    for line in text.splitlines():
+        f = line.split()
+        if f[:1] == ['thermal'] and len(f) == 8:
+            keys = ['ceil', 'peak', 'over', 'settle', 'osc', 'lm', 'lost']
+            return dict(zip(keys, [float(x) for x in f[1:]]))
+    return None
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
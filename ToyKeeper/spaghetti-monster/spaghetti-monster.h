@@ -29,6 +29,8 @@
 
 // include project definitions to help with recognizing symbols
 #include "fsm-events.h"
+#include "fsm-coroutine.h"
+#include "fsm-tasks.h"
 #include "fsm-states.h"
 #include "fsm-adc.h"
 #include "fsm-wdt.h"
@@ -36,9 +38,11 @@
 #include "fsm-standby.h"
 #include "fsm-ramping.h"
 #include "fsm-random.h"
+#include "fsm-timers.h"
 #ifdef USE_EEPROM
 #include "fsm-eeprom.h"
 #endif
+#include "fsm-trace.h"
 #include "fsm-misc.h"
 #include "fsm-main.h"
 
@@ -74,8 +78,12 @@ void loop();
 #include "fsm-standby.c"
 #include "fsm-ramping.c"
 #include "fsm-random.c"
+#include "fsm-timers.c"
+#include "fsm-coroutine.c"
+#include "fsm-tasks.c"
 #ifdef USE_EEPROM
 #include "fsm-eeprom.c"
 #endif
+#include "fsm-trace.c"
 #include "fsm-misc.c"
 #include "fsm-main.c"
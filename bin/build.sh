@@ -2,6 +2,19 @@
 
 # Instead of using a Makefile, since most of the firmwares here build in the
 # same exact way, here's a script to do the same thing
+#
+# Set BUILD_DIR to put the .o/.elf/.hex there instead of next to the source,
+# so several targets can build at once.  Then it also skips the build if
+# nothing changed since last time:  not the source, the headers, or the
+# compiler and its flags.
+#
+# If the cfg file (or a cfg it includes) has a line like this...
+#   // RAMP: seventh 3 150 7135 1 2.3 130 7135 11 5 400.1 FET 2 10 4000
+# ... then the ramp tables get generated from it by level_calc.py, and
+# the cfg doesn't need to paste in PWM*_LEVELS itself.
+#
+# If it has "#define USE_PACKED_RAMPS", the tables get packed by
+# ramp_pack.py too, so the packed tables always match PWM*_LEVELS.
 
 if [ -z "$1" ]; then
   echo "Usage: build.sh MCU myprogram"
@@ -45,9 +58,72 @@ function run () {
   if [ x"$?" != x0 ]; then exit 1 ; fi
 }
 
-run $CC $OTHERFLAGS $CFLAGS -o $PROGRAM.o -c $PROGRAM.c
-run $CC $OFLAGS $LDFLAGS -o $PROGRAM.elf $PROGRAM.o
-run $OBJCOPY $OBJCOPYFLAGS $PROGRAM.elf $PROGRAM.hex
+# find a line in a cfg file, or in whatever cfg it includes
+function cfg_line () {
+  local LINE=$(grep -m 1 "$1" "$2")
+  if [ -z "$LINE" ]; then
+    for INC in $(sed -n 's/^#include "\([^"]*cfg-[^"]*\)".*/\1/p' "$2"); do
+      LINE=$(cfg_line "$1" "$(dirname "$2")/$INC")
+      if [ -n "$LINE" ]; then break ; fi
+    done
+  fi
+  echo $LINE
+}
+
+OUT=$PROGRAM
+if [ -n "$BUILD_DIR" ]; then
+  mkdir -p "$BUILD_DIR" || exit 1
+  OUT="$BUILD_DIR/$PROGRAM"
+fi
+
+# generate the ramp tables, if the cfg describes them
+# (only touch the header when it changes, or everything would rebuild)
+CFG=$(echo " $OTHERFLAGS " | sed -n 's/.* -DCONFIGFILE=\([^ ]*\) .*/\1/p')
+if [ -n "$CFG" ]; then
+  SPEC=$(cfg_line '^// RAMP:' "$CFG" | sed 's/^\/\/ RAMP://')
+  PACK=$(cfg_line '^#define USE_PACKED_RAMPS' "$CFG")
+fi
+if [ -n "$SPEC$PACK" ]; then
+  BIN=$(dirname "$0")
+  : > "$OUT.ramp.h.new"
+  if [ -n "$SPEC" ]; then
+    "$BIN/level_calc.py" --header $SPEC >> "$OUT.ramp.h.new" || exit 1
+  fi
+  if [ -n "$PACK" ]; then
+    PACKED=$("$BIN/ramp_pack.py" --header "$CFG" "$OUT.ramp.h.new") || exit 1
+    echo "$PACKED" >> "$OUT.ramp.h.new"
+  fi
+  if cmp -s "$OUT.ramp.h.new" "$OUT.ramp.h" ; then rm -f "$OUT.ramp.h.new"
+  else mv -f "$OUT.ramp.h.new" "$OUT.ramp.h" ; fi
+  OTHERFLAGS="$OTHERFLAGS -DRAMPFILE=\"$(pwd)/$OUT.ramp.h\""
+fi
+
+if [ -n "$BUILD_DIR" ]; then
+  DEPFLAGS="-MMD -MF $OUT.d"
+  FLAGS="$($CC --version | head -n 1) $OTHERFLAGS $CFLAGS $OFLAGS $LDFLAGS $OBJCOPYFLAGS"
+
+  # up to date?  (the .d file lists every header it used)
+  STALE=1
+  if [ -f "$OUT.hex" -a -f "$OUT.d" -a -f "$OUT.flags" ]; then
+    if [ "$FLAGS" = "$(cat "$OUT.flags")" ]; then
+      STALE=0
+      for DEP in $(sed -e 's/^[^:]*://' -e 's/\\$//' "$OUT.d"); do
+        if [ "$DEP" -nt "$OUT.hex" ]; then STALE=1 ; break ; fi
+      done
+    fi
+  fi
+  if [ 0 = $STALE ]; then
+    echo "$OUT.hex is up to date"
+    exit 0
+  fi
+  rm -f "$OUT.hex" "$OUT.flags"
+fi
+
+run $CC $OTHERFLAGS $CFLAGS $DEPFLAGS -o $OUT.o -c $PROGRAM.c
+run $CC $OFLAGS $LDFLAGS -o $OUT.elf $OUT.o
+run $OBJCOPY $OBJCOPYFLAGS $OUT.elf $OUT.hex
 # deprecated
-#run avr-size -C --mcu=$MCU $PROGRAM.elf | grep Full
-run avr-objdump -Pmem-usage $PROGRAM.elf | grep Full
+#run avr-size -C --mcu=$MCU $OUT.elf | grep Full
+run avr-objdump -Pmem-usage $OUT.elf | grep Full
+# (only after it all worked, so a failed build doesn't count as up to date)
+if [ -n "$BUILD_DIR" ]; then echo "$FLAGS" > "$OUT.flags" ; fi
@@ -11,13 +11,22 @@ interactive = False
 max_pwm = 255
 max_pwms = []
 dyn_pwm = False
+fine_steps = 0
+header = False
+dither = 0
 
 
 def main(args):
     """Calculates PWM levels for visually-linear steps.
+
+    With --header, prints only #defines for a C header, like the build
+    makes from a cfg file's "RAMP:" line.  --dither N adds PWM1_DITHER,
+    for USE_PWM_DITHER on the lowest N levels.  --pwm fine:N:255 is
+    dynamic PWM for an 8-bit timer:  the lowest N levels get their own
+    TOP, and the rest stay at 255.
     """
     cli_answers = []
-    global max_pwm, max_pwms, dyn_pwm
+    global max_pwm, max_pwms, dyn_pwm, fine_steps, header, dither
     pwm_arg = str(max_pwm)
 
     i = 0
@@ -26,6 +35,11 @@ def main(args):
         if a in ('--pwm',):
             i += 1
             pwm_arg = args[i]
+        elif a in ('--header',):
+            header = True
+        elif a in ('--dither',):
+            i += 1
+            dither = int(args[i])
         else:
             #print('unrecognized option: "%s"' % (a,))
             cli_answers.append(a)
@@ -78,6 +92,16 @@ def main(args):
                 max_pwms[i] = int(x)
             max_pwm = dpwn_min
 
+        elif pwm_arg.startswith('fine:'):
+            # dynamic PWM for an 8-bit timer, like Timer1 on a tiny85:
+            # TOP never goes higher than usual, but the lowest levels
+            # can use a lower TOP to get between two PWM values
+            dyn_pwm = True
+            parts = pwm_arg.split(':')
+            fine_steps = int(parts[1])
+            max_pwm = int(parts[2])
+            max_pwms = [max_pwm] * answers.num_levels
+
         else:
             val = int(pwm_arg)
             max_pwm = val
@@ -110,6 +134,9 @@ def main(args):
     # figure out the desired PWM values
     multi_pwm(answers, channels)
 
+    if header:
+        print_header(args, channels)
+
     if interactive: # Wait on exit, in case user invoked us by clicking an icon
         print('Press Enter to exit:')
         input_text()
@@ -178,7 +205,7 @@ def multi_pwm(answers, channels):
                 pwm_top = max_pwms[i]
                 pwm_avail = pwm_top - channel.pwm_min
                 pwm_needed = pwm_avail * lm_needed / lm_avail
-                if dyn_pwm and (pwm_top > max_pwm):
+                if dyn_pwm and ((pwm_top > max_pwm) or (i < fine_steps)):
                     this_step = max(1, math.floor(pwm_needed))
                     next_step = this_step + 1
                     fpart = pwm_needed - math.floor(pwm_needed)
@@ -201,6 +228,10 @@ def multi_pwm(answers, channels):
             else:
                 channel.modes.append(0)
 
+    # (the header only needs the numbers)
+    if header:
+        return
+
     # Show individual levels in detail
     prev_ratios = [0.0] * len(channels)
     for i in range(answers.num_levels):
@@ -231,15 +262,66 @@ def multi_pwm(answers, channels):
 
     # Show highest level for each channel before next channel starts
     for cnum, channel in enumerate(channels[:-1]):
-        prev = 0
-        i = 1
-        while (i < answers.num_levels) \
-                and (channels[cnum+1].modes[i] == 0):
-                #and (channel.modes[i] >= channel.modes[i-1]) \
-            i += 1
+        i = channel_max(channels, cnum)
         print('Ch%i max: %i (%.2f/%s)' % (cnum, i, channel.modes[i-1], max_pwms[i]))
 
 
+def channel_max(channels, cnum):
+    """Highest level (1-based) before the next channel starts"""
+    num_levels = len(channels[cnum].modes)
+    i = 1
+    while (i < num_levels) \
+            and (int(round(channels[cnum+1].modes[i])) == 0):
+            #and (channel.modes[i] >= channel.modes[i-1]) \
+        i += 1
+    return i
+
+
+def print_header(args, channels):
+    """Show the same values as #defines, for the build to include
+
+    Each one only gets defined if the cfg file didn't already, so it can
+    still override anything by hand.
+    """
+    def define(name, value):
+        print('#ifndef %s' % (name,))
+        print('#define %s %s' % (name, value))
+        print('#endif')
+
+    print('// generated by level_calc.py %s' %
+          (' '.join(a for a in args if a != '--header'),))
+    num_levels = len(channels[0].modes)
+    for cnum, channel in enumerate(channels):
+        define('PWM%s_LEVELS' % (cnum+1),
+               ','.join([str(int(round(i))) for i in channel.modes]))
+    if dyn_pwm:
+        define('PWM_TOPS', ','.join(str(x) for x in max_pwms))
+    if dither:
+        define('PWM1_DITHER', ','.join(str(d) for d in
+               dither_table(channels[0], dither)))
+
+    # top of the 7135-only part of the ramp, and of each 7135 bank
+    if len(channels) == 1:
+        define('MAX_1x7135', num_levels)
+    else:
+        define('MAX_1x7135', channel_max(channels, 0))
+        if (len(channels) > 2) and (channels[1].type == '7135'):
+            define('MAX_Nx7135', channel_max(channels, 1))
+
+
+def dither_table(channel, num_levels):
+    """How far each level is from its rounded PWM value, in 16ths"""
+    ditherings = []
+    for pwm in channel.modes[:num_levels]:
+        whole = int(round(pwm))
+        d = int(round((pwm - whole) * 16))
+        # don't dither down to (or below) the lowest visible level
+        if (d < 0) and (whole <= channel.pwm_min):
+            d = 0
+        ditherings.append(d)
+    return ditherings
+
+
 def get_value(text, default, args):
     """Get input from the user, or from the command line args."""
     if args:
@@ -0,0 +1,216 @@
+#!/usr/bin/env python
+
+"""Packs a cfg file's ramp tables, to save flash.
+
+Usage:  ramp_pack.py [--bits N] [--header] cfg-foo.h [ramp.h]
+
+Reads the PWM1_LEVELS ... PWM4_LEVELS and PWM_TOPS tables from the
+file (and from any cfg-*.h it includes, and from ramp.h, which is what
+level_calc.py --header made for the cfg's "RAMP:" line, if any), and
+prints packed versions of them.
+
+bin/build.sh and sim/build.sh run it with --header when a cfg has
+"#define USE_PACKED_RAMPS", and the firmware includes what it prints.
+So the cfg only keeps the regular tables, and the packed ones can't go
+stale.  Without --header, it also says how much that saves.
+
+Each packed table is:
+    first      levels before this index are 0
+    count      how many levels are in the span
+    top        the top level's value  (1 byte, or 2 for 16-bit PWM)
+    jumps      (count-1)/16 bytes:  where each later group of 16 levels
+               starts, counting from the start of the deltas
+    deltas     count bytes, each the change from the level before it
+               (from 0 for the first one in each group of 16), or -128
+               followed by the value itself (1 or 2 bytes) when it
+               changed too much
+Levels after the span stay at its last value, except the top level.  So
+a channel only stores the part of the ramp where it's actually ramping,
+and most of that fits in one byte per level.  fsm-ramping.c decodes it
+with ramp_unpack(), which jumps to the right group and then only has to
+add up 16 deltas at most.
+
+--bits defaults to 16 if any value is over 255, or 8 otherwise.  8-bit
+tables work with any PWM_BITS, but 16-bit tables need 16-bit PWM (the
+firmware checks).
+"""
+
+from __future__ import print_function
+
+import os
+import re
+import sys
+
+TABLES = ['PWM1_LEVELS', 'PWM2_LEVELS', 'PWM3_LEVELS', 'PWM4_LEVELS',
+          'PWM_TOPS']
+ESCAPE = -128
+GROUP = 16  # levels between jumps  (ramp_unpack() has this built in)
+
+
+def main(args):
+    bits = None
+    header = False
+    paths = []
+    while args:
+        a = args.pop(0)
+        if a == '--bits':
+            bits = int(args.pop(0))
+        elif a == '--header':
+            header = True
+        elif a in ('-h', '--help'):
+            print(__doc__.strip())
+            return 0
+        else:
+            paths.append(a)
+    if not paths:
+        print(__doc__.strip())
+        return 1
+    path = paths[0]
+
+    # generated tables first, so anything the cfg defines takes precedence
+    defs = {}
+    for p in paths[1:]:
+        read_defines(p, defs)
+    read_defines(path, defs)
+    tables = [(t, [int(x) for x in expand(defs, t).split(',') if x])
+              for t in TABLES if t in defs]
+    if not tables:
+        print('%s: no PWM*_LEVELS tables' % path, file=sys.stderr)
+        return 1
+    if bits is None:
+        bits = 8
+        if max(max(v) for t, v in tables) > 255:
+            bits = 16
+    width = bits > 8 and 2 or 1
+
+    size = len(tables[0][1])
+    lines = []
+    before = after = 0
+    for name, values in tables:
+        if len(values) != size:
+            print('%s has %i levels, not %i' % (name, len(values), size),
+                  file=sys.stderr)
+            return 1
+        packed = pack(values, width)
+        if unpack(packed, size, width) != values:  # (just in case)
+            print("%s didn't survive packing" % name, file=sys.stderr)
+            return 1
+        before += size * width
+        after += len(packed)
+        lines.append('#define %s %s' % (packed_name(name),
+                                        ','.join(str(b) for b in packed)))
+
+    if header:
+        print('// generated by ramp_pack.py %s' % path)
+    else:
+        print('// packed by ramp_pack.py  (%i bytes -> %i)' % (before, after))
+    print('#define PACKED_PWM_BITS %i' % bits)
+    print('#ifndef RAMP_SIZE')
+    print('#define RAMP_SIZE %i' % size)
+    print('#endif')
+    for line in lines:
+        print(line)
+    return 0
+
+
+def packed_name(name):
+    """PWM1_LEVELS -> PWM1_PACKED,  PWM_TOPS -> PWM_TOPS_PACKED"""
+    if name.endswith('_LEVELS'):
+        return name[:-len('_LEVELS')] + '_PACKED'
+    return name + '_PACKED'
+
+
+def read_defines(path, defs):
+    """Every #define in a file, in order, following cfg-*.h includes"""
+    text = open(path).read().replace('\\\n', ' ')
+    for line in text.splitlines():
+        m = re.match(r'^\s*#define\s+(\w+)\s+(.*?)\s*(?://.*)?$', line)
+        if m:
+            defs[m.group(1)] = re.sub(r'\s+', '', m.group(2))
+        m = re.match(r'^\s*#undef\s+(\w+)', line)
+        if m:
+            defs.pop(m.group(1), None)
+        m = re.match(r'^\s*#include\s+"([^"]*cfg-[^"]*)"', line)
+        if m:
+            read_defines(os.path.join(os.path.dirname(path), m.group(1)),
+                         defs)
+    return defs
+
+
+def expand(defs, name, depth=0):
+    """A table's values, with any macros in it filled in"""
+    if depth > 16:
+        raise ValueError('%s goes too deep' % name)
+    return ','.join(t in defs and expand(defs, t, depth + 1) or t
+                    for t in defs[name].split(',') if t)
+
+
+def le_bytes(value, width):
+    return [(value >> (8 * i)) & 0xff for i in range(width)]
+
+
+def pack(values, width):
+    """One table, as a list of bytes"""
+    body = values[:-1]
+    first = 0
+    while first < len(body) and body[first] == 0:
+        first += 1
+    end = len(body)
+    while end > first + 1 and body[end - 1] == body[end - 2]:
+        end -= 1
+    span = body[first:end]
+
+    jumps = []
+    deltas = []
+    for i, v in enumerate(span):
+        if not i % GROUP:
+            if i:
+                jumps.append(len(deltas))
+            prev = 0
+        d = v - prev
+        if ESCAPE < d < 128:
+            deltas.append(d & 0xff)
+        else:
+            deltas += [ESCAPE & 0xff] + le_bytes(v, width)
+        prev = v
+    if jumps and jumps[-1] > 255:
+        raise ValueError('span is too big to pack')
+    return [first, len(span)] + le_bytes(values[-1], width) + jumps + deltas
+
+
+def unpack_level(packed, level, width):
+    """One level, the same way ramp_unpack() does it"""
+    def value(p):
+        return sum(b << (8 * i) for i, b in enumerate(packed[p:p + width]))
+
+    first, count = packed[0], packed[1]
+    if level < first:
+        return 0
+    level = min(level - first, count - 1)
+    p = 2 + width + (count - 1) // GROUP
+    if level >= GROUP:
+        p += packed[2 + width + level // GROUP - 1]
+    level %= GROUP
+    v = 0
+    while True:
+        d = packed[p] - 256 * (packed[p] > 127)
+        p += 1
+        if d == ESCAPE:
+            v = value(p)
+            p += width
+        else:
+            v = (v + d) & ((1 << (8 * width)) - 1)
+        if not level:
+            return v
+        level -= 1
+
+
+def unpack(packed, size, width):
+    """The whole table"""
+    top = sum(b << (8 * i) for i, b in enumerate(packed[2:2 + width]))
+    return [unpack_level(packed, level, width)
+            for level in range(size - 1)] + [top]
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
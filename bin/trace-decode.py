@@ -0,0 +1,154 @@
+#!/usr/bin/env python
+
+"""Decodes the FSM event trace (USE_EVENT_TRACE) from an EEPROM dump.
+
+After a watchdog reset, FSM copies its trace buffer to the end of the
+EEPROM.  To read it:
+
+    avrdude -c usbasp -p t85 -u -Ueeprom:r:eeprom.hex:i
+    trace-decode.py eeprom.hex
+
+Raw binary dumps (avrdude's ":r" format) work too.  Use --len if the
+firmware was built with a TRACE_LEN other than 16.
+"""
+
+from __future__ import print_function
+
+import sys
+
+TRACE_LEN = 16
+TRACE_EEP_MARKER = 0b01011010
+TRACE_BOOT = 0xFE
+TICK_MS = 16
+
+B_CLICK = 0b10000000
+B_TIMEOUT = 0b01000000
+B_HOLD = 0b00100000
+B_PRESS = 0b00010000
+B_COUNT = 0b00001111
+
+system_events = {
+    0b00000000: 'none',
+    0b00000001: 'tick',
+    0b00000010: 'timer',
+    0b00000011: 'sleep_tick',
+    0b00000100: 'voltage_low',
+    0b00000101: 'temperature_high',
+    0b00000110: 'temperature_low',
+    0b00000111: 'temperature_okay',
+    0b00001000: 'enter_state',
+    0b00001001: 'leave_state',
+    0b00001010: 'reenter_state',
+    0b01111111: 'debug',
+}
+
+# same bits on tiny85, tiny1634, and tiny1616
+reset_flags = ['PORF', 'EXTRF', 'BORF', 'WDRF', 'SWRF', 'UPDIRF']
+
+
+def main(args):
+    """Print the trace, oldest event first"""
+    length = TRACE_LEN
+    if '--len' in args:
+        i = args.index('--len')
+        length = int(args[i+1])
+        del args[i:i+2]
+    if not args:
+        print(__doc__.strip())
+        return 1
+
+    data = pad(load(args[0]))
+    size = 2 + (length * 4)
+    if len(data) < size:
+        print('Dump is too small.')
+        return 1
+    block = data[-size:]
+    if block[0] != TRACE_EEP_MARKER:
+        print('No trace found.  (wrong --len, or no crash since flashing?)')
+        return 1
+
+    pos = block[1] % length
+    entries = [block[2+(i*4):6+(i*4)] for i in range(length)]
+    entries = entries[pos:] + entries[:pos]
+
+    print('tick   +ms  state     event')
+    last = None
+    for tick, event, arg, state in entries:
+        if not (tick or event or arg or state):
+            continue  # empty slot
+        delta = ''
+        if last is not None:
+            delta = '+%i' % (((tick - last) & 0xff) * TICK_MS)
+        last = tick
+        if state == TRACE_BOOT:
+            print('%4i %5s  ----      BOOT  reset flags: %s' % (
+                tick, delta, flag_names(arg)))
+            last = None
+            continue
+        where = '%i' % state
+        if state == 0xFF:
+            where = 'unhandled'
+        print('%4i %5s  %-9s %s  arg=%i' % (
+            tick, delta, where, event_name(event), arg))
+    return 0
+
+
+def event_name(event):
+    if not (event & B_CLICK):
+        return 'EV_' + system_events.get(event, 'system_%02x' % event)
+    count = event & B_COUNT
+    if event & B_HOLD:
+        if event & B_PRESS:
+            return 'EV_click%i_hold' % count
+        return 'EV_click%i_hold_release' % count
+    if event & B_PRESS:
+        return 'EV_click%i_press' % count
+    if event & B_TIMEOUT:
+        return 'EV_click%i_complete' % count
+    if not count:
+        return 'EV_release'
+    return 'EV_click%i_release' % count
+
+
+def flag_names(flags):
+    names = [n for i, n in enumerate(reset_flags) if flags & (1 << i)]
+    if not names:
+        return 'none  (jumped to 0?)'
+    return ' '.join(names)
+
+
+def load(path):
+    """Read an Intel hex or raw binary dump as a list of bytes"""
+    raw = bytearray(open(path, 'rb').read())
+    if not raw.startswith(b':'):
+        return list(raw)
+
+    mem = {}
+    base = 0
+    for line in raw.decode('ascii').split():
+        rec = bytearray.fromhex(line.strip()[1:])
+        count, addr, kind = rec[0], (rec[1] << 8) | rec[2], rec[3]
+        if kind == 0:
+            for i in range(count):
+                mem[base + addr + i] = rec[4+i]
+        elif kind == 2:
+            base = ((rec[4] << 8) | rec[5]) << 4
+        elif kind == 4:
+            base = ((rec[4] << 8) | rec[5]) << 16
+        elif kind == 1:
+            break
+    if not mem:
+        return []
+    return [mem.get(i, 0xff) for i in range(max(mem) + 1)]
+
+
+def pad(data):
+    """avrdude leaves out trailing 0xFF bytes, so put them back"""
+    size = 1
+    while size < len(data):
+        size *= 2
+    return data + [0xff] * (size - len(data))
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))